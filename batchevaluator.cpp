@@ -0,0 +1,212 @@
+/**
+ * FlappyBird++
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ **/
+#include <algorithm>
+#include <unordered_map>
+#include "neat/profiler.h"
+#include "batchevaluator.h"
+#include "trainer.h"
+
+namespace flappybirdplusplus
+{
+    BatchEvaluator::BatchEvaluator(Simulation& simulation) :
+        m_simulation(simulation)
+    {
+    }
+
+    void BatchEvaluator::reset(const std::vector<NEAT::Organism*>& organisms, std::shared_ptr<const Course> course)
+    {
+        NEAT_PROFILE_SCOPE("compile");
+
+        m_organisms = organisms;
+        m_outputs.assign(organisms.size(), 0.0);
+
+        m_networks.clear();
+        m_networks.reserve(organisms.size());
+        for(const auto* organism : organisms) {
+            m_networks.push_back(organism->gnome->compile());
+        }
+        buildBatches();
+
+        m_simulation.reset(organisms.size(), std::move(course));
+
+        m_steps = 0;
+        m_start = std::chrono::steady_clock::now();
+        m_reachedLimit = false;
+        m_nextDecision = 0;
+        m_activations = 0;
+    }
+
+    std::size_t BatchEvaluator::think()
+    {
+        // the flaps of the last decision are held by the simulation
+        if(!isDecisionTick())
+            return 0;
+        m_nextDecision = m_steps + std::max<std::size_t>(m_decisionInterval.ticks, 1);
+        m_activations += m_simulation.getAliveBirds().size();
+
+        NEAT_PROFILE_HOT_SCOPE("activation");
+        NEAT_PROFILE_COUNT("activations", m_simulation.getAliveBirds().size());
+
+        std::size_t flapCount = 0;
+        for(auto i : m_simulation.getAliveBirds()) {
+            auto [batch, lane] = m_batchLanes[i];
+            if(batch == NO_BATCH) {
+                m_outputs[i] = Trainer::activate(m_networks[i], m_simulation.getSensorInputs(i));
+                if(m_simulation.control(m_outputs[i] > Trainer::FLAP_THRESHOLD, i))
+                    ++flapCount;
+            } else {
+                m_batches[batch].networks.loadSensors(lane, m_simulation.getSensorInputs(i).data());
+                m_batches[batch].active = true;
+            }
+        }
+
+        // the lanes of dead birds are activated along, the batch is only
+        // skipped once all of its birds are dead
+        for(auto& batch : m_batches) {
+            if(!batch.active)
+                continue;
+
+            batch.active = false;
+            batch.networks.activate();
+
+            m_aliveLanes.clear();
+            for(std::size_t lane = 0; lane < batch.birds.size(); ++lane) {
+                auto i = batch.birds[lane];
+                if(m_simulation.isDead(i))
+                    continue;
+
+                m_aliveLanes.push_back(lane);
+                m_outputs[i] = batch.networks.getOutput(lane, 0);
+                if(m_simulation.control(m_outputs[i] > Trainer::FLAP_THRESHOLD, i))
+                    ++flapCount;
+            }
+
+            // once half of the lanes are dead, drop them from the batch
+            if(m_aliveLanes.size() * 2 <= batch.birds.size())
+                compactBatch(batch, m_aliveLanes);
+        }
+
+        return flapCount;
+    }
+
+    unsigned int BatchEvaluator::step()
+    {
+        if(m_simulation.isStarted())
+            ++m_steps;
+
+        auto events = m_simulation.step();
+        if(m_simulation.isStarted() && isOverLimit()) {
+            m_simulation.finish();
+            m_reachedLimit = true;
+        }
+
+        return events;
+    }
+
+    void BatchEvaluator::evaluate()
+    {
+        NEAT_PROFILE_SCOPE("episode");
+
+        m_simulation.start();
+        while(!m_simulation.isDead()) {
+            think();
+            step();
+        }
+
+        writeFitness();
+    }
+
+    bool BatchEvaluator::isOverLimit() const
+    {
+        if(m_limits.maxSteps > 0 && m_steps >= m_limits.maxSteps)
+            return true;
+        if(m_limits.maxScore > 0 && m_simulation.getScore() >= m_limits.maxScore)
+            return true;
+        if(m_limits.maxSeconds > 0.0) {
+            std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - m_start;
+            return elapsed.count() >= m_limits.maxSeconds;
+        }
+
+        return false;
+    }
+
+    bool BatchEvaluator::isDecisionTick() const
+    {
+        if(m_steps >= m_nextDecision)
+            return true;
+        if(m_decisionInterval.nearDistance <= 0)
+            return false;
+
+        // the birds all fly at the same x, until they have flown past the
+        // pair the distance is negative
+        auto birdX = m_simulation.getBirds().getFixedPosition(0).x;
+        return m_simulation.getNextObstacle().first.position.x - birdX < toFixed(m_decisionInterval.nearDistance);
+    }
+
+    void BatchEvaluator::buildBatches()
+    {
+        // group the networks by topology, the hash may collide so every
+        // group is checked against its first network
+        std::unordered_map<std::uint64_t, std::vector<std::vector<std::size_t>>> groups;
+        for(std::size_t i = 0; i < m_networks.size(); ++i) {
+            auto& candidates = groups[m_networks[i].getTopologyHash()];
+            auto it = std::find_if(candidates.begin(), candidates.end(), [this, i](const std::vector<std::size_t>& group) {
+                return m_networks[group.front()].hasSameTopology(m_networks[i]);
+            });
+            if(it != candidates.end())
+                it->push_back(i);
+            else
+                candidates.push_back({ i });
+        }
+
+        m_batches.clear();
+        m_batchLanes.assign(m_networks.size(), { NO_BATCH, 0 });
+        for(auto& [hash, candidates] : groups) {
+            for(auto& group : candidates) {
+                if(group.size() < MIN_BATCH_SIZE)
+                    continue;
+
+                std::vector<const NEAT::CompiledNetwork*> networks;
+                for(std::size_t lane = 0; lane < group.size(); ++lane) {
+                    networks.push_back(&m_networks[group[lane]]);
+                    m_batchLanes[group[lane]] = { m_batches.size(), lane };
+                }
+                m_batches.push_back(TopologyBatch{ NEAT::NetworkBatch(networks), std::move(group), false });
+            }
+        }
+    }
+
+    void BatchEvaluator::compactBatch(TopologyBatch& batch, const std::vector<std::size_t>& aliveLanes)
+    {
+        batch.networks.retainLanes(aliveLanes);
+
+        std::vector<std::size_t> birds;
+        for(std::size_t lane = 0; lane < aliveLanes.size(); ++lane) {
+            auto i = batch.birds[aliveLanes[lane]];
+            m_batchLanes[i].second = lane;
+            birds.push_back(i);
+        }
+        batch.birds = std::move(birds);
+    }
+
+    void BatchEvaluator::writeFitness() const
+    {
+        for(std::size_t i = 0; i < m_organisms.size(); ++i) {
+            m_organisms[i]->fitness = Trainer::computeFitness(m_simulation, i);
+        }
+    }
+}
@@ -0,0 +1,127 @@
+/**
+ * FlappyBird++
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ **/
+#ifndef BATCHEVALUATOR_H
+#define BATCHEVALUATOR_H
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "neat/compiled_network.h"
+#include "neat/network_batch.h"
+#include "neat/organism.h"
+#include "simulation.h"
+
+namespace flappybirdplusplus
+{
+    // End an episode although birds are still flying, 0 turns a limit
+    // off. A bird that reaches maxScore ends the episode with that score, so
+    // every bird that masters the course gets the same capped fitness
+    struct EpisodeLimits
+    {
+        std::size_t     maxSteps = 0;
+        unsigned int    maxScore = 0;
+
+        // wall time of the whole episode. The organisms of a batch fly together,
+        // so this bounds the time of each of them, at the cost of repeatable runs
+        double          maxSeconds = 0.0;
+    };
+
+    // How often the networks are asked what to do, in between the birds hold
+    // their last action. Within nearDistance pixels of the next obstacle pair
+    // the networks are asked on every tick again, 0 keeps the interval
+    // everywhere
+    struct DecisionInterval
+    {
+        std::size_t     ticks = 1;
+        int             nearDistance = 0;
+    };
+
+    // Flies every organism as its own bird through one shared course, all
+    // birds in lockstep, so a whole generation is evaluated in a single game.
+    // The organisms are flown by compiled copies of their networks, and the
+    // networks sharing a topology are activated together as a NetworkBatch
+    class BatchEvaluator
+    {
+    public:
+        // smallest group of identical topologies worth a NetworkBatch
+        static constexpr std::size_t MIN_BATCH_SIZE = 2;
+
+        explicit BatchEvaluator(Simulation& simulation);
+
+        void reset(const std::vector<NEAT::Organism*>& organisms, std::shared_ptr<const Course> course);
+
+        // activates the networks on the ticks of a decision, returns the birds
+        // that flap. Does nothing on the other ticks
+        std::size_t think();
+
+        // steps the simulation and ends the game once a limit is reached
+        unsigned int step();
+        void evaluate();
+        void writeFitness() const;
+
+        void setLimits(const EpisodeLimits& limits) { m_limits = limits; }
+        const EpisodeLimits& getLimits() const { return m_limits; }
+        bool hasReachedLimit() const { return m_reachedLimit; }
+
+        void setDecisionInterval(const DecisionInterval& interval) { m_decisionInterval = interval; }
+        const DecisionInterval& getDecisionInterval() const { return m_decisionInterval; }
+
+        // network activations since the reset, one per living bird and decision
+        std::uint64_t getActivations() const { return m_activations; }
+
+        double getOutput(std::size_t bird) const { return m_outputs[bird]; }
+
+    private:
+        static constexpr std::size_t NO_BATCH = static_cast<std::size_t>(-1);
+
+        struct TopologyBatch
+        {
+            NEAT::NetworkBatch          networks;
+            std::vector<std::size_t>    birds;
+            bool                        active;
+        };
+
+        bool isOverLimit() const;
+        bool isDecisionTick() const;
+
+        void buildBatches();
+        void compactBatch(TopologyBatch& batch, const std::vector<std::size_t>& aliveLanes);
+
+        Simulation&                         m_simulation;
+        std::vector<NEAT::Organism*>        m_organisms;
+        std::vector<NEAT::CompiledNetwork>  m_networks;
+        std::vector<double>                 m_outputs;
+
+        EpisodeLimits                       m_limits;
+        std::size_t                         m_steps = 0;
+        std::chrono::steady_clock::time_point m_start;
+        bool                                m_reachedLimit = false;
+
+        DecisionInterval                    m_decisionInterval;
+        std::size_t                         m_nextDecision = 0;
+        std::uint64_t                       m_activations = 0;
+
+        std::vector<TopologyBatch>          m_batches;
+        // batch and lane of every bird, NO_BATCH for the unique topologies
+        std::vector<std::pair<std::size_t, std::size_t>> m_batchLanes;
+        // the living lanes of the batch think() is at, kept to reuse its memory
+        std::vector<std::size_t>            m_aliveLanes;
+    };
+}
+
+#endif // BATCHEVALUATOR_H
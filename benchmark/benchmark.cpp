@@ -0,0 +1,482 @@
+/**
+ * FlappyBird++
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ **/
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+#include "../neat/gene.h"
+#include "../neat/genome.h"
+#include "../neat/neat_initialize.h"
+#include "../neat/network.h"
+#include "../neat/organism.h"
+#include "../neat/pool.h"
+#include "../neat/population.h"
+#include "../neat/species.h"
+#include "../neat/thread_pool.h"
+#include "../batchevaluator.h"
+#include "../simulation.h"
+#include "../trainer.h"
+
+// Throughput of the training hot paths, with fixed seeds so two builds
+// run the same work, e.g.
+// benchmark --format csv --output results.csv --min-time 1 --filter epoch
+namespace
+{
+    using namespace flappybirdplusplus;
+
+    constexpr std::uint64_t BENCHMARK_SEED = 42;
+    constexpr unsigned int  COURSE_WIDTH = 288;
+    constexpr unsigned int  COURSE_HEIGHT = 512;
+
+    struct Result
+    {
+        std::string     name;
+        std::string     parameter;
+        std::uint64_t   iterations;
+        double          seconds;
+        std::string     unit;
+
+        double getRate() const { return seconds > 0.0 ? iterations / seconds : 0.0; }
+    };
+
+    struct Options
+    {
+        double          minTime = 0.5;
+        std::size_t     threads = 1;
+        std::string     filter;
+    };
+
+    // Calls body until minTime has passed, body returns how many units of
+    // work it did
+    Result measure(const std::string& name, const std::string& parameter, const std::string& unit,
+                   const Options& options, const std::function<std::uint64_t()>& body)
+    {
+        using Clock = std::chrono::steady_clock;
+
+        std::uint64_t iterations = 0;
+        auto start = Clock::now();
+        auto elapsed = 0.0;
+        do {
+            iterations += body();
+            elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+        } while(elapsed < options.minTime);
+
+        return { name, parameter, iterations, elapsed, unit };
+    }
+
+    // A cheap stand-in for flying: small weights and a little size win,
+    // so epochs keep growing structure without running the game
+    void assignFitness(NEAT::Population& population)
+    {
+        for(auto* organism : population.organisms) {
+            auto sum = 0.0;
+            for(const auto* gene : organism->gnome->genes) {
+                sum += gene->lnk->weight * gene->lnk->weight;
+            }
+            organism->fitness = 1.0 / (1.0 + sum) + organism->gnome->genes.size() * 0.01;
+        }
+
+        for(auto* species : population.species) {
+            species->compute_average_fitness();
+            species->compute_max_fitness();
+        }
+    }
+
+    std::unique_ptr<NEAT::Population> createPopulation(std::size_t size, NEAT::ThreadPool& pool)
+    {
+        // delta coding and the offspring check of reproduce assume pop_size
+        NEAT::pop_size = static_cast<int>(size);
+
+        NEAT::Genome start(4, 1, 1, 2);
+        auto population = std::make_unique<NEAT::Population>(&start, static_cast<int>(size), BENCHMARK_SEED);
+        population->thread_pool = &pool;
+        return population;
+    }
+
+    // A population after some epochs with frequent structural mutations,
+    // so the genomes look like the ones of a run that went on for a while
+    std::unique_ptr<NEAT::Population> createGrownPopulation(std::size_t size, int epochs, NEAT::ThreadPool& pool)
+    {
+        auto population = createPopulation(size, pool);
+
+        auto addNodeProb = NEAT::mutate_add_node_prob;
+        auto addLinkProb = NEAT::mutate_add_link_prob;
+        NEAT::mutate_add_node_prob = 0.2;
+        NEAT::mutate_add_link_prob = 0.3;
+        for(int generation = 2; generation < epochs + 2; ++generation) {
+            assignFitness(*population);
+            population->epoch(generation);
+        }
+        NEAT::mutate_add_node_prob = addNodeProb;
+        NEAT::mutate_add_link_prob = addLinkProb;
+
+        return population;
+    }
+
+    void benchmarkActivation(std::vector<Result>& results, const Options& options)
+    {
+        const double inputs[] = { 0.25, -0.5, 0.75, 1.0, 1.0 };
+        for(int hidden : { 0, 8, 32, 128 }) {
+            NEAT::RNG rng(BENCHMARK_SEED);
+            NEAT::Genome genome(0, 5, 1, hidden, hidden, false, 0.3, rng);
+            NEAT::Organism organism(0.0, new NEAT::Genome(genome), 1);
+            auto parameter = std::to_string(hidden) + " hidden";
+
+            auto* network = organism.get_net();
+            results.push_back(measure("network_activate", parameter, "activations/s", options, [&]() {
+                for(int i = 0; i < 1000; ++i) {
+                    network->load_sensors(inputs);
+                    network->activate();
+                }
+                return 1000;
+            }));
+
+            auto compiled = genome.compile();
+            results.push_back(measure("compiled_network_activate", parameter, "activations/s", options, [&]() {
+                for(int i = 0; i < 1000; ++i) {
+                    compiled.loadSensors(inputs);
+                    compiled.activate();
+                }
+                return 1000;
+            }));
+        }
+    }
+
+    void benchmarkGenomes(std::vector<Result>& results, const Options& options, NEAT::ThreadPool& pool)
+    {
+        auto population = createGrownPopulation(1000, 30, pool);
+        const auto& organisms = population->organisms;
+
+        auto genes = 0.0;
+        for(const auto* organism : organisms) {
+            genes += organism->gnome->genes.size();
+        }
+        auto parameter = std::to_string(static_cast<int>(genes / organisms.size())) + " genes";
+
+        // every organism against a fixed stride of partners
+        auto partner = [&](std::size_t i) { return organisms[(i * 7 + 1) % organisms.size()]; };
+
+        results.push_back(measure("genome_compatibility", parameter, "comparisons/s", options, [&]() {
+            auto sum = 0.0;
+            for(std::size_t i = 0; i < organisms.size(); ++i) {
+                sum += organisms[i]->gnome->compatibility(partner(i)->gnome);
+            }
+            return sum != -1.0 ? organisms.size() : 0;
+        }));
+
+        NEAT::RNG rng(BENCHMARK_SEED);
+        results.push_back(measure("genome_mate_multipoint", parameter, "matings/s", options, [&]() {
+            for(std::size_t i = 0; i < organisms.size(); ++i) {
+                auto* mom = organisms[i];
+                auto* dad = partner(i);
+                delete mom->gnome->mate_multipoint(dad->gnome, static_cast<int>(i), mom->orig_fitness,
+                                                   dad->orig_fitness, false, rng);
+            }
+            return organisms.size();
+        }));
+    }
+
+    // Two parents that share a large random ancestor and then split apart
+    // by node mutations, so each also brings genes of its own like the
+    // genomes of a long run
+    std::pair<std::unique_ptr<NEAT::Genome>, std::unique_ptr<NEAT::Genome>> createLargeParents(int hidden)
+    {
+        NEAT::RNG rng(BENCHMARK_SEED);
+        NEAT::InnovationDatabase innovations;
+
+        NEAT::Genome ancestor(0, 5, 1, hidden, hidden, false, 0.3, rng);
+        auto nodeId = ancestor.get_last_node_id();
+        auto innovation = ancestor.get_last_gene_innovnum();
+
+        std::unique_ptr<NEAT::Genome> mom(ancestor.duplicate(1));
+        std::unique_ptr<NEAT::Genome> dad(ancestor.duplicate(2));
+        for(auto* parent : { mom.get(), dad.get() }) {
+            for(std::size_t i = 0, mutations = ancestor.genes.size() / 4; i < mutations; ++i) {
+                parent->mutate_add_node(innovations, nodeId, innovation, rng);
+            }
+        }
+        return { std::move(mom), std::move(dad) };
+    }
+
+    void benchmarkMating(std::vector<Result>& results, const Options& options)
+    {
+        using Mate = std::function<NEAT::Genome*(NEAT::Genome&, NEAT::Genome&, NEAT::RNG&)>;
+        const std::pair<const char*, Mate> methods[] = {
+            { "genome_mate_multipoint_large", [](NEAT::Genome& mom, NEAT::Genome& dad, NEAT::RNG& rng) {
+                return mom.mate_multipoint(&dad, 3, 1.0, 1.0, false, rng);
+            } },
+            { "genome_mate_multipoint_avg_large", [](NEAT::Genome& mom, NEAT::Genome& dad, NEAT::RNG& rng) {
+                return mom.mate_multipoint_avg(&dad, 3, 1.0, 1.0, false, rng);
+            } },
+            { "genome_mate_singlepoint_large", [](NEAT::Genome& mom, NEAT::Genome& dad, NEAT::RNG& rng) {
+                return mom.mate_singlepoint(&dad, 3, rng);
+            } }
+        };
+
+        for(int hidden : { 16, 64, 128 }) {
+            auto [mom, dad] = createLargeParents(hidden);
+            auto parameter = std::to_string((mom->genes.size() + dad->genes.size()) / 2) + " genes";
+
+            for(const auto& [name, mate] : methods) {
+                NEAT::RNG rng(BENCHMARK_SEED);
+                results.push_back(measure(name, parameter, "matings/s", options, [&, &mate = mate]() {
+                    delete mate(*mom, *dad, rng);
+                    return 1;
+                }));
+            }
+        }
+    }
+
+    void benchmarkEpoch(std::vector<Result>& results, const Options& options, NEAT::ThreadPool& pool)
+    {
+        for(std::size_t size : { 100, 1000, 10000 }) {
+            auto population = createPopulation(size, pool);
+            auto generation = 1;
+            results.push_back(measure("population_epoch", std::to_string(size) + " organisms", "epochs/s", options, [&]() {
+                assignFitness(*population);
+                population->epoch(++generation);
+                return 1;
+            }));
+        }
+    }
+
+    void benchmarkEpisode(std::vector<Result>& results, const Options& options, NEAT::ThreadPool& pool)
+    {
+        auto population = createGrownPopulation(100, 10, pool);
+        auto& organisms = population->organisms;
+        auto parameter = std::to_string(organisms.size()) + " birds";
+
+        // invincible birds fly the whole episode, so every call does the same work
+        constexpr std::size_t EPISODE_STEPS = 128 * 10;
+        auto course = std::make_shared<const Course>(static_cast<std::uint32_t>(BENCHMARK_SEED), COURSE_HEIGHT);
+        results.push_back(measure("episode_step", parameter, "steps/s", options, [&]() {
+            Simulation simulation(COURSE_WIDTH, COURSE_HEIGHT);
+            simulation.setInvincible(true);
+
+            BatchEvaluator evaluator(simulation);
+            evaluator.reset(organisms, course);
+            evaluator.setLimits({ EPISODE_STEPS, 0, 0.0 });
+            evaluator.evaluate();
+            return EPISODE_STEPS;
+        }));
+
+        // the same episode with the networks asked every few ticks
+        for(std::size_t ticks : { 4, 8 }) {
+            results.push_back(measure("episode_decision", parameter + " every " + std::to_string(ticks) + " ticks",
+                                      "steps/s", options, [&]() {
+                Simulation simulation(COURSE_WIDTH, COURSE_HEIGHT);
+                simulation.setInvincible(true);
+
+                BatchEvaluator evaluator(simulation);
+                evaluator.reset(organisms, course);
+                evaluator.setLimits({ EPISODE_STEPS, 0, 0.0 });
+                evaluator.setDecisionInterval({ ticks, 0 });
+                evaluator.evaluate();
+                return EPISODE_STEPS;
+            }));
+        }
+
+        // the headless training evaluation, birds die as they crash
+        std::uint32_t courseSeed = 0;
+        results.push_back(measure("episode_evaluate", parameter, "evals/s", options, [&]() {
+            Simulation simulation(COURSE_WIDTH, COURSE_HEIGHT);
+            BatchEvaluator evaluator(simulation);
+            evaluator.reset(organisms, std::make_shared<const Course>(courseSeed++, COURSE_HEIGHT));
+            evaluator.setLimits({ Trainer::MAX_EPISODE_STEPS, 0, 0.0 });
+            evaluator.evaluate();
+            return organisms.size();
+        }));
+    }
+
+    // Worker threads allocate and the main thread frees, like the babies of
+    // a parallel reproduction that the next epoch deletes. Once the first
+    // rounds have filled the free lists the pool must not grow any more
+    bool checkPool(std::ostream& out)
+    {
+        struct Object
+        {
+            unsigned char   bytes[64];
+        };
+        using ObjectPool = NEAT::Pool<Object>;
+
+        constexpr std::size_t   TASKS = 16;
+        constexpr std::size_t   OBJECTS_PER_TASK = 4 * ObjectPool::OBJECTS_PER_SLAB;
+        constexpr int           WARMUP_ROUNDS = 5;
+        constexpr int           ROUNDS = 50;
+
+        NEAT::ThreadPool threads(4);
+        std::vector<std::vector<void*>> objects(TASKS);
+        std::uint64_t warmSlabs = 0;
+        for(int round = 0; round < ROUNDS; ++round) {
+            if(round == WARMUP_ROUNDS)
+                warmSlabs = ObjectPool::getCounters().slabs;
+
+            threads.parallelFor(TASKS, [&](std::size_t task) {
+                for(std::size_t i = 0; i < OBJECTS_PER_TASK; ++i) {
+                    objects[task].push_back(ObjectPool::allocate());
+                }
+            });
+            for(auto& taskObjects : objects) {
+                for(auto* object : taskObjects) {
+                    ObjectPool::deallocate(object);
+                }
+                taskObjects.clear();
+            }
+        }
+
+        auto slabs = ObjectPool::getCounters().slabs;
+        auto flat = slabs == warmSlabs;
+        out << "pool: " << warmSlabs << " slabs after " << WARMUP_ROUNDS << " rounds, " << slabs
+            << " after " << ROUNDS << (flat ? " ok" : " GROWING") << std::endl;
+
+        // the same with real epochs. The genes of the old and of the new
+        // generation are alive together, the rest of the slabs only holds
+        // the few batches of free slots every thread keeps
+        constexpr int EPOCHS = 40;
+        auto population = createPopulation(1000, threads);
+        std::uint64_t peakGenes = 0;
+        for(int generation = 2; generation < EPOCHS + 2; ++generation) {
+            assignFitness(*population);
+            population->epoch(generation);
+
+            auto counters = NEAT::Pool<NEAT::Gene>::getCounters();
+            peakGenes = std::max(peakGenes, counters.allocations - counters.deallocations);
+        }
+
+        auto geneSlabs = NEAT::Pool<NEAT::Gene>::getCounters().slabs;
+        auto geneSlots = geneSlabs * NEAT::Pool<NEAT::Gene>::OBJECTS_PER_SLAB;
+        auto bounded = geneSlots <= 2 * peakGenes + threads.getThreadCount() * 4 * NEAT::Pool<NEAT::Gene>::OBJECTS_PER_SLAB;
+        out << "epochs: " << geneSlabs << " gene slabs for at most " << peakGenes << " genes after " << EPOCHS
+            << " epochs" << (bounded ? " ok" : " GROWING") << std::endl;
+
+        return flat && bounded;
+    }
+
+    void writeJson(std::ostream& out, const std::vector<Result>& results, const Options& options)
+    {
+        out << "{\n  \"seed\": " << BENCHMARK_SEED << ",\n  \"threads\": " << options.threads
+            << ",\n  \"benchmarks\": [\n";
+        for(std::size_t i = 0; i < results.size(); ++i) {
+            const auto& result = results[i];
+            out << "    { \"name\": \"" << result.name << "\", \"parameter\": \"" << result.parameter
+                << "\", \"iterations\": " << result.iterations << ", \"seconds\": " << result.seconds
+                << ", \"rate\": " << result.getRate() << ", \"unit\": \"" << result.unit << "\" }"
+                << (i + 1 < results.size() ? ",\n" : "\n");
+        }
+        out << "  ]\n}" << std::endl;
+    }
+
+    void writeCsv(std::ostream& out, const std::vector<Result>& results)
+    {
+        out << "name,parameter,iterations,seconds,rate,unit\n";
+        for(const auto& result : results) {
+            out << result.name << ',' << result.parameter << ',' << result.iterations << ','
+                << result.seconds << ',' << result.getRate() << ',' << result.unit << '\n';
+        }
+        out.flush();
+    }
+
+    const char* findArgument(int argc, char** argv, const char* name, bool hasValue)
+    {
+        for(auto i = 1; i < argc; ++i) {
+            if(std::strcmp(argv[i], name) == 0) {
+                if(!hasValue)
+                    return argv[i];
+
+                return i + 1 < argc ? argv[i + 1] : nullptr;
+            }
+        }
+
+        return nullptr;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    Options options;
+    if(auto value = findArgument(argc, argv, "--min-time", true); value)
+        options.minTime = std::strtod(value, nullptr);
+    if(auto value = findArgument(argc, argv, "--threads", true); value)
+        options.threads = std::strtoul(value, nullptr, 10);
+    if(auto value = findArgument(argc, argv, "--filter", true); value)
+        options.filter = value;
+
+    std::string format = "json";
+    if(auto value = findArgument(argc, argv, "--format", true); value)
+        format = value;
+    if(format != "json" && format != "csv") {
+        std::cerr << "Unknown format \"" << format << "\", use json or csv" << std::endl;
+        return -1;
+    }
+
+    // NEAT logs its epochs on std::cout in debug builds, stdout is kept for
+    // the results alone
+    std::ostream report(std::cout.rdbuf());
+    std::cout.rdbuf(nullptr);
+
+    NEAT::initializeParameters();
+
+    // allocates on worker threads and frees on this one, exits with 1 when
+    // the pool keeps growing
+    if(findArgument(argc, argv, "--check-pool", false))
+        return checkPool(report) ? 0 : 1;
+
+    NEAT::ThreadPool pool(options.threads);
+    options.threads = pool.getThreadCount();
+
+    // a filter picks the groups whose name contains it
+    const std::vector<std::pair<std::string, std::function<void(std::vector<Result>&)>>> groups = {
+        { "network_activate", [&](std::vector<Result>& results) { benchmarkActivation(results, options); } },
+        { "genome_compatibility genome_mate_multipoint", [&](std::vector<Result>& results) { benchmarkGenomes(results, options, pool); } },
+        { "genome_mate_multipoint_large genome_mate_multipoint_avg_large genome_mate_singlepoint_large",
+          [&](std::vector<Result>& results) { benchmarkMating(results, options); } },
+        { "population_epoch", [&](std::vector<Result>& results) { benchmarkEpoch(results, options, pool); } },
+        { "episode_step episode_decision episode_evaluate", [&](std::vector<Result>& results) { benchmarkEpisode(results, options, pool); } }
+    };
+
+    std::vector<Result> results;
+    for(const auto& group : groups) {
+        if(group.first.find(options.filter) != std::string::npos) {
+            group.second(results);
+        }
+    }
+
+    std::ofstream file;
+    if(auto value = findArgument(argc, argv, "--output", true); value) {
+        file.open(value);
+        if(!file.is_open()) {
+            std::cerr << "Cannot open \"" << value << "\"" << std::endl;
+            return -1;
+        }
+    }
+
+    auto& out = file.is_open() ? static_cast<std::ostream&>(file) : report;
+    if(format == "json")
+        writeJson(out, results, options);
+    else
+        writeCsv(out, results);
+
+    return 0;
+}
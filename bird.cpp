@@ -32,37 +32,19 @@ namespace flappybirdplusplus
     {
     }
 
-    void Bird::preReset()
-    {
-        m_oldPosition = m_position;
-    }
-
-    void Bird::reset(float x, float y)
+    void Bird::updateAnimation(float dt)
     {
-        m_position.x = x;
-        m_position.y = y;
-        m_oldPosition.x = x;
-        m_oldPosition.y = y;
-
-        m_OOBB.width = 32;
-        m_OOBB.height = 24;
-        m_OOBB.left = x - (m_OOBB.width / 2.f);
-        m_OOBB.top = y - (m_OOBB.height / 2.f);
-
-        m_rotation = 0.f;
-        m_upAcceleration = 0.f;
-        m_downAcceleration = 0.f;
-        m_downAccelerationTime = 0.f;
+        m_animation.update(dt);
     }
 
-    void Bird::draw(sf::RenderWindow& renderWindow, float alpha)
+    void Bird::draw(sf::RenderWindow& renderWindow, const BirdSwarm& birds, std::size_t bird, float alpha)
     {
 //        assert(m_birdTexture[0]);
 //        assert(m_birdTexture[1]);
 //        assert(m_birdTexture[2]);
 
         auto* currentAnimation = m_animation.getCurrentAnimationTexture();
-        auto renderPosition = linearInterpolation(m_oldPosition, m_position, alpha);
+        auto renderPosition = linearInterpolation(birds.getOldPosition(bird), birds.getPosition(bird), alpha);
         renderPosition.x = std::roundf(renderPosition.x);
         renderPosition.y = std::roundf(renderPosition.y);
         const auto& spriteSize = currentAnimation->getSize();
@@ -72,55 +54,10 @@ namespace flappybirdplusplus
 
         sf::Sprite sprite;
         sprite.setOrigin(spriteSizef);
-        sprite.setRotation(m_rotation);
+        sprite.setRotation(birds.getRotation(bird));
         sprite.setPosition(renderPosition);
         sprite.setTexture(*currentAnimation);
 
         renderWindow.draw(sprite/*, renderState*/);
     }
-
-    void Bird::applyUpForce()
-    {
-        m_upAcceleration = -800.f;
-    }
-
-    void Bird::resetUpForce()
-    {
-        m_upAcceleration = 0.f;
-        m_downAcceleration = 0.f;
-
-        m_downAccelerationTime = 0.0f;
-    }
-
-    void Bird::updateAnimation(float dt)
-    {
-        m_animation.update(dt);
-    }
-
-    void Bird::update(float dt)
-    {
-        m_oldPosition = m_position;
-        if(m_upAcceleration < -1.0f) {
-            if(m_OOBB.top > m_OOBB.height / 2.f) {
-                auto adjustedUpForce = m_upAcceleration * dt;
-                m_position.y += adjustedUpForce;
-                m_OOBB.top += adjustedUpForce;
-            }
-            m_rotation -= 800.f * dt;
-            m_rotation = std::max(m_rotation, -50.f);
-        } else {
-            m_downAccelerationTime += dt;
-
-            m_downAcceleration += (100.f * m_downAccelerationTime);
-            m_downAcceleration = std::min(m_downAcceleration, 800.f);
-
-            auto adjustedDownForce = m_downAcceleration * dt;
-            m_position.y += adjustedDownForce;
-            m_OOBB.top += adjustedDownForce;
-
-            auto rotation = (800.f * m_downAccelerationTime);
-            m_rotation += rotation * dt;
-            m_rotation = std::min(m_rotation, 80.f);
-        }
-    }
 }
@@ -20,6 +20,7 @@
 #include <SFML/Graphics.hpp>
 #include <SFML/System.hpp>
 #include "birdanimation.h"
+#include "birdswarm.h"
 
 namespace flappybirdplusplus
 {
@@ -31,34 +32,12 @@ namespace flappybirdplusplus
              const sf::Texture& birdMidFlapTexture,
              const sf::Texture& birdUpFlapTexture);
 
-        void preReset();
-        void reset(float x, float y);
-
-        void draw(sf::RenderWindow& renderWindow, float alpha);
-
-        void applyUpForce();
-        void resetUpForce();
-
         void updateAnimation(float dt);
-        void update(float dt);
 
-        const sf::Vector2f& getPosition() const { return m_position; }
-        const sf::FloatRect& getOOBB() const { return m_OOBB; }
-        float getRotation() const { return m_rotation; }
+        void draw(sf::RenderWindow& renderWindow, const BirdSwarm& birds, std::size_t bird, float alpha);
 
     private:
         BirdAnimation       m_animation;
-
-        sf::FloatRect       m_OOBB;
-
-        sf::Vector2f        m_oldPosition;
-        sf::Vector2f        m_position;
-
-        float               m_rotation;
-
-        float               m_upAcceleration;
-        float               m_downAcceleration;
-        float               m_downAccelerationTime;
     };
 }
 
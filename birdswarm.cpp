@@ -0,0 +1,188 @@
+/**
+ * FlappyBird++
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ **/
+#include <algorithm>
+#include <numeric>
+#include <utility>
+#include "birdswarm.h"
+
+namespace flappybirdplusplus
+{
+    void BirdSwarm::reset(std::size_t count, Fixed x, Fixed y)
+    {
+        m_x = x;
+        m_y.assign(count, y);
+        m_oldY.assign(count, y);
+        m_rotation.assign(count, 0);
+        m_fallSpeed.assign(count, 0);
+        m_fallSpeedGain.assign(count, 0);
+        m_rising.assign(count, 0);
+        m_hit.assign(count, 0);
+
+        m_ids.resize(count);
+        std::iota(m_ids.begin(), m_ids.end(), 0);
+        m_slots = m_ids;
+        m_aliveCount = count;
+        m_fallingCount = 0;
+    }
+
+    void BirdSwarm::applyUpForce(std::size_t bird)
+    {
+        m_rising[m_slots[bird]] = 1;
+    }
+
+    void BirdSwarm::resetUpForce(std::size_t bird)
+    {
+        auto slot = m_slots[bird];
+        m_rising[slot] = 0;
+        m_fallSpeed[slot] = 0;
+        m_fallSpeedGain[slot] = 0;
+    }
+
+    void BirdSwarm::updateAlive()
+    {
+        update(0, m_aliveCount);
+    }
+
+    void BirdSwarm::updateFalling(const AABB& ground)
+    {
+        auto begin = m_aliveCount;
+        auto end = m_aliveCount + m_fallingCount;
+
+        // the landed birds are moved behind the falling ones
+        markHits(ground, begin, end);
+        auto falling = begin;
+        for(auto i = begin; i < end; ++i) {
+            if(!m_hit[i]) {
+                if(i != falling)
+                    swapSlots(i, falling);
+                ++falling;
+            }
+        }
+        for(auto i = falling; i < end; ++i) {
+            m_oldY[i] = m_y[i];
+            m_hit[i] = 0;
+        }
+        m_fallingCount = falling - begin;
+
+        update(begin, falling);
+    }
+
+    void BirdSwarm::markHits(const AABB& box)
+    {
+        markHits(box, 0, m_aliveCount);
+    }
+
+    const std::vector<std::size_t>& BirdSwarm::removeHits()
+    {
+        // the survivors keep their order
+        std::size_t alive = 0;
+        for(std::size_t i = 0; i < m_aliveCount; ++i) {
+            if(!m_hit[i]) {
+                if(i != alive)
+                    swapSlots(i, alive);
+                ++alive;
+            }
+        }
+
+        // the dead stop flapping and start falling from where they are
+        m_removed.clear();
+        for(auto i = alive; i < m_aliveCount; ++i) {
+            m_oldY[i] = m_y[i];
+            m_rising[i] = 0;
+            m_fallSpeed[i] = 0;
+            m_fallSpeedGain[i] = 0;
+            m_hit[i] = 0;
+            m_removed.push_back(m_ids[i]);
+        }
+
+        m_fallingCount += m_aliveCount - alive;
+        m_aliveCount = alive;
+        return m_removed;
+    }
+
+    AABB BirdSwarm::getOOBB(std::size_t bird) const
+    {
+        return AABB(m_x - WIDTH / 2, m_y[m_slots[bird]] - HEIGHT / 2, WIDTH, HEIGHT);
+    }
+
+    void BirdSwarm::update(std::size_t begin, std::size_t end)
+    {
+        auto* y = m_y.data();
+        auto* oldY = m_oldY.data();
+        auto* rotation = m_rotation.data();
+        auto* fallSpeed = m_fallSpeed.data();
+        auto* fallSpeedGain = m_fallSpeedGain.data();
+        const auto* rising = m_rising.data();
+
+        // one loop per field, each computes the rising and the falling value
+        // and selects one, so none has a branch and all of them vectorize
+        for(auto i = begin; i < end; ++i) {
+            oldY[i] = y[i];
+        }
+
+        for(auto i = begin; i < end; ++i) {
+            auto gain = fallSpeedGain[i] + FALL_ACCELERATION;
+            auto speed = std::min(fallSpeed[i] + gain, MAX_FALL_SPEED);
+            fallSpeedGain[i] = rising[i] ? fallSpeedGain[i] : gain;
+            fallSpeed[i] = rising[i] ? fallSpeed[i] : speed;
+        }
+
+        // a rising bird stops once its box reaches half its height below the top
+        for(auto i = begin; i < end; ++i) {
+            auto risenY = y[i] > HEIGHT ? y[i] - RISE_SPEED : y[i];
+            auto fallenY = y[i] + fallSpeed[i];
+            y[i] = rising[i] ? risenY : fallenY;
+        }
+
+        for(auto i = begin; i < end; ++i) {
+            auto risenRotation = std::max(rotation[i] - RISE_TURN, MIN_ROTATION);
+            auto fallenRotation = std::min(rotation[i] + fallSpeedGain[i] * FALL_TURN_PER_GAIN, MAX_ROTATION);
+            rotation[i] = rising[i] ? risenRotation : fallenRotation;
+        }
+    }
+
+    void BirdSwarm::markHits(const AABB& box, std::size_t begin, std::size_t end)
+    {
+        // the birds share their column, so one test covers all of them
+        auto left = m_x - WIDTH / 2;
+        if(!(std::max(left, box.left) < std::min(left + WIDTH, box.left + box.width)))
+            return;
+
+        const auto* y = m_y.data();
+        auto* hit = m_hit.data();
+        auto boxBottom = box.top + box.height;
+        for(auto i = begin; i < end; ++i) {
+            auto top = y[i] - HEIGHT / 2;
+            hit[i] |= std::max(top, box.top) < std::min(top + HEIGHT, boxBottom);
+        }
+    }
+
+    void BirdSwarm::swapSlots(std::size_t a, std::size_t b)
+    {
+        std::swap(m_y[a], m_y[b]);
+        std::swap(m_oldY[a], m_oldY[b]);
+        std::swap(m_rotation[a], m_rotation[b]);
+        std::swap(m_fallSpeed[a], m_fallSpeed[b]);
+        std::swap(m_fallSpeedGain[a], m_fallSpeedGain[b]);
+        std::swap(m_rising[a], m_rising[b]);
+        std::swap(m_hit[a], m_hit[b]);
+        std::swap(m_ids[a], m_ids[b]);
+
+        m_slots[m_ids[a]] = a;
+        m_slots[m_ids[b]] = b;
+    }
+}
@@ -0,0 +1,118 @@
+/**
+ * FlappyBird++
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ **/
+#ifndef BIRDSWARM_H
+#define BIRDSWARM_H
+
+#include <cstdint>
+#include <vector>
+#include <SFML/System/Vector2.hpp>
+#include "geometry.h"
+
+namespace flappybirdplusplus
+{
+    // Physics state of every bird of a simulation, no rendering involved.
+    // Each field is an array with one slot per bird: the alive birds come
+    // first, then the dead ones still falling to the ground, then the landed
+    // ones. The per tick physics and the box tests are loops over plain
+    // integer arrays that the compiler vectorizes, and dying birds are moved
+    // out of the alive slots so the loops never skip over them.
+    // Birds are addressed by their id, the slot is internal. One tick is
+    // one step of the simulation, see fixedpoint.h
+    class BirdSwarm
+    {
+    public:
+        static constexpr Fixed  WIDTH = 32 * FIXED_ONE;
+        static constexpr Fixed  HEIGHT = 24 * FIXED_ONE;
+
+        // rising moves and turns the bird by 800 units per second, falling
+        // speeds up by 100 pixels per second every second it has fallen
+        static constexpr Fixed  RISE_SPEED = perTick(800);
+        static constexpr Fixed  RISE_TURN = perTick(800);
+        static constexpr Fixed  FALL_ACCELERATION = perTick(100) / TICKS_PER_SECOND;
+        static constexpr Fixed  MAX_FALL_SPEED = perTick(800);
+        static constexpr Fixed  FALL_TURN = perTick(800) / TICKS_PER_SECOND;
+        static constexpr Fixed  FALL_TURN_PER_GAIN = FALL_TURN / FALL_ACCELERATION;
+        static constexpr Fixed  MIN_ROTATION = -50 * FIXED_ONE;
+        static constexpr Fixed  MAX_ROTATION = 80 * FIXED_ONE;
+
+        static_assert(FALL_TURN % FALL_ACCELERATION == 0, "the fall turn is derived from the speed gain");
+
+        // every bird alive at the same place
+        void reset(std::size_t count, Fixed x, Fixed y);
+
+        void applyUpForce(std::size_t bird);
+        void resetUpForce(std::size_t bird);
+
+        // one tick of the alive birds
+        void updateAlive();
+
+        // one tick of the falling birds, the ones that touch the ground stop there
+        void updateFalling(const AABB& ground);
+
+        // marks the alive birds whose box intersects box
+        void markHits(const AABB& box);
+
+        // moves the marked birds to the falling ones and returns their ids
+        const std::vector<std::size_t>& removeHits();
+
+        std::size_t getCount() const { return m_ids.size(); }
+        std::size_t getAliveCount() const { return m_aliveCount; }
+
+        // ids of the alive birds in ascending order, then the falling and the landed ones
+        const std::vector<std::size_t>& getIds() const { return m_ids; }
+
+        FixedVector2 getFixedPosition(std::size_t bird) const { return { m_x, m_y[m_slots[bird]] }; }
+        Fixed getFixedRotation(std::size_t bird) const { return m_rotation[m_slots[bird]]; }
+        AABB getOOBB(std::size_t bird) const;
+
+        // for rendering
+        sf::Vector2f getPosition(std::size_t bird) const { return toFloat(getFixedPosition(bird)); }
+        sf::Vector2f getOldPosition(std::size_t bird) const { return { toFloat(m_x), toFloat(m_oldY[m_slots[bird]]) }; }
+        float getRotation(std::size_t bird) const { return toFloat(getFixedRotation(bird)); }
+
+    private:
+        void update(std::size_t begin, std::size_t end);
+        void markHits(const AABB& box, std::size_t begin, std::size_t end);
+        void swapSlots(std::size_t a, std::size_t b);
+
+        // the birds never move sideways
+        Fixed                       m_x = 0;
+
+        std::vector<Fixed>          m_y;
+        std::vector<Fixed>          m_oldY;
+        std::vector<Fixed>          m_rotation;
+
+        // units per tick. The gain grows by FALL_ACCELERATION every tick
+        // fallen and is added to the speed, so no multiplication is needed,
+        // which the vector units of older cpus do not have for 32 bits
+        std::vector<Fixed>          m_fallSpeed;
+        std::vector<Fixed>          m_fallSpeedGain;
+
+        // 0 or 1, as wide as the other fields so they vectorize together
+        std::vector<std::int32_t>   m_rising;
+        std::vector<std::int32_t>   m_hit;
+
+        std::vector<std::size_t>    m_ids;
+        std::vector<std::size_t>    m_slots;
+        std::size_t                 m_aliveCount = 0;
+        std::size_t                 m_fallingCount = 0;
+
+        std::vector<std::size_t>    m_removed;
+    };
+}
+
+#endif // BIRDSWARM_H
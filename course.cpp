@@ -0,0 +1,62 @@
+/**
+ * FlappyBird++
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ **/
+#include <algorithm>
+#include <random>
+#include "course.h"
+#include "simulation.h"
+
+namespace flappybirdplusplus
+{
+    Course::Course(std::uint32_t seed, unsigned int height, std::size_t length) :
+        m_firstRepeated(0),
+        m_seed(seed),
+        m_height(height)
+    {
+        auto courseHeight = static_cast<int>(height);
+        auto foregroundY = static_cast<int>(Simulation::FOREGROUND_Y);
+        auto maxHeight = courseHeight * 3 / 5 - foregroundY;
+        auto minHeight = 50;
+
+        // a pair is placed when the closest one scrolls off the screen, by
+        // then every pair before that one has been scored
+        std::mt19937 random(seed);
+        length = std::max(length, Simulation::OBSTACLE_COUNT + 1);
+        m_pairs.reserve(length);
+        for(std::size_t i = 0; i < length; ++i) {
+            auto upperHeight = minHeight + static_cast<int>(random() % maxHeight);
+
+            auto distance = i == 0 ? FIRST_DISTANCE : START_DISTANCE;
+            if(i >= Simulation::OBSTACLE_COUNT) {
+                auto score = static_cast<int>(i - Simulation::OBSTACLE_COUNT + 1);
+                distance = std::max(START_DISTANCE - score * DISTANCE_PER_POINT, MIN_DISTANCE);
+            }
+            if(distance > MIN_DISTANCE)
+                m_firstRepeated = i + 1;
+
+            m_pairs.push_back({ static_cast<std::int16_t>(upperHeight), static_cast<std::int16_t>(distance) });
+        }
+        m_firstRepeated = std::min(m_firstRepeated, length - 1);
+    }
+
+    const Course::Pair& Course::getPair(std::size_t index) const
+    {
+        if(index < m_pairs.size())
+            return m_pairs[index];
+
+        return m_pairs[m_firstRepeated + (index - m_pairs.size()) % (m_pairs.size() - m_firstRepeated)];
+    }
+}
@@ -0,0 +1,67 @@
+/**
+ * FlappyBird++
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ **/
+#ifndef COURSE_H
+#define COURSE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace flappybirdplusplus
+{
+    // The obstacle pairs of a course, drawn from its seed ahead of time: the
+    // gap heights come from the seed and the distances from the difficulty,
+    // which only depends on how many pairs came before. A course never
+    // changes once built, so one course is shared by the simulations of
+    // every thread and the whole generation flies the same pipes
+    class Course
+    {
+    public:
+        // the first pair is 500 pixels into the course and the next ones 250
+        // apart, every point scored brings the next pair 2 pixels closer
+        static constexpr int            FIRST_DISTANCE = 500;
+        static constexpr int            START_DISTANCE = 250;
+        static constexpr int            DISTANCE_PER_POINT = 2;
+        static constexpr int            MIN_DISTANCE = 150;
+
+        // more than the pairs of 10 minutes of game time
+        static constexpr std::size_t    DEFAULT_LENGTH = 1024;
+
+        struct Pair
+        {
+            std::int16_t    upperHeight;    // pixels
+            std::int16_t    distance;       // pixels from the pair before
+        };
+
+        Course(std::uint32_t seed, unsigned int height, std::size_t length = DEFAULT_LENGTH);
+
+        // past its end the course repeats its pairs of full difficulty
+        const Pair& getPair(std::size_t index) const;
+
+        std::uint32_t getSeed() const { return m_seed; }
+        unsigned int getHeight() const { return m_height; }
+        std::size_t getLength() const { return m_pairs.size(); }
+
+    private:
+        std::vector<Pair>   m_pairs;
+        std::size_t         m_firstRepeated;
+        std::uint32_t       m_seed;
+        unsigned int        m_height;
+    };
+}
+
+#endif // COURSE_H
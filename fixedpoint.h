@@ -0,0 +1,58 @@
+/**
+ * FlappyBird++
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ **/
+#ifndef FIXEDPOINT_H
+#define FIXEDPOINT_H
+
+#include <cstdint>
+#include <SFML/System/Vector2.hpp>
+
+namespace flappybirdplusplus
+{
+    // The simulation keeps positions, speeds and angles as 16.16 fixed point
+    // integers and advances in ticks of 1 / TICKS_PER_SECOND seconds. At that
+    // rate every speed of the game is a whole number of fixed point units per
+    // tick, so no step ever rounds and a course plays out bit for bit the same
+    // whatever the compiler, its flags or the cpu. Floats are only made for
+    // rendering and for the network inputs
+    using Fixed = std::int32_t;
+
+    static constexpr int    FIXED_FRACTION_BITS = 16;
+    static constexpr Fixed  FIXED_ONE = Fixed(1) << FIXED_FRACTION_BITS;
+    static constexpr Fixed  TICKS_PER_SECOND = 128;
+
+    constexpr Fixed toFixed(int value) { return value * FIXED_ONE; }
+
+    // a speed in units per second as units per tick
+    constexpr Fixed perTick(int valuePerSecond) { return toFixed(valuePerSecond) / TICKS_PER_SECOND; }
+
+    // toDouble is exact, toFloat rounds beyond 256 units
+    inline double toDouble(Fixed value) { return static_cast<double>(value) / FIXED_ONE; }
+    inline float toFloat(Fixed value) { return static_cast<float>(toDouble(value)); }
+
+    struct FixedVector2
+    {
+        FixedVector2() : x(0), y(0) {}
+        FixedVector2(Fixed x, Fixed y) : x(x), y(y) {}
+
+        Fixed x;
+        Fixed y;
+    };
+
+    inline sf::Vector2f toFloat(const FixedVector2& value) { return { toFloat(value.x), toFloat(value.y) }; }
+}
+
+#endif // FIXEDPOINT_H
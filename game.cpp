@@ -15,10 +15,7 @@
  * along with this program.  If not, see <https://www.gnu.org/licenses/>.
  **/
 #include <cmath>
-#include <filesystem>
-#include <fstream>
-#include <iostream>
-#include "neat/neat_initialize.h"
+#include "neat/organism.h"
 #include "game.h"
 #include "utility.h"
 
@@ -38,10 +35,13 @@ namespace
     // Rotate the bird's bounding box
     // Menu?
     // Highscore?
-    static constexpr float FOREGROUND_Y = 100.f;
-    static constexpr float BIRD_STARTING_X = 50.f;
+    static constexpr float FOREGROUND_Y = Simulation::FOREGROUND_Y;
 
     Game::Game(unsigned int windowWidth, unsigned int windowHeight) :
+        m_trainer(windowWidth, windowHeight),
+        m_simulation(windowWidth, windowHeight),
+        m_evaluator(m_simulation),
+        m_step(0),
         m_debugMode(false)
 #ifndef NDEBUG
       , m_godMode(false)
@@ -49,7 +49,7 @@ namespace
     {
         // initialize renderer
         m_renderWindow.create(sf::VideoMode(windowWidth, windowHeight),
-                              "FlappyBird++ AI : Generation " + std::to_string(m_generation));
+                              "FlappyBird++ AI : Generation " + std::to_string(m_trainer.getGeneration()));
 
         // initialize the background
         m_background.setSize(sf::Vector2f(windowWidth, windowHeight));
@@ -59,10 +59,6 @@ namespace
         m_foreground.setSize(sf::Vector2f(windowWidth, FOREGROUND_Y));
         m_foregroundPositions.push_back({ 0.f, 0.f });
         m_foregroundPositions.push_back({ windowWidth, windowWidth });
-        m_foregroundOOBB.left = 0;
-        m_foregroundOOBB.top = windowHeight - FOREGROUND_Y;
-        m_foregroundOOBB.width = windowWidth;
-        m_foregroundOOBB.height = FOREGROUND_Y;
 
         // initialize the obstacle ends
         m_obstacleUpperEnd.setSize(sf::Vector2f(52, 24));
@@ -70,23 +66,10 @@ namespace
 
         m_gameOverFlash.setSize(sf::Vector2f(windowWidth, windowHeight));
         m_gameOverFlash.setPosition(0, 0);
-
-        NEAT::initializeParameters();
-
-        if(std::filesystem::exists(std::filesystem::path("population.txt"))) {
-          m_population = std::make_unique<NEAT::Population>("population.txt");
-        } else {
-          m_startGenome = std::make_unique<NEAT::Genome>(4, 1, 1, 2);
-          m_population = std::make_unique<NEAT::Population>(m_startGenome.get(), 100);
-        }
     }
 
     Game::~Game()
     {
-      std::ofstream out("population.txt");
-      if(out.is_open()) {
-        m_population->print_to_file_by_species(out);
-      }
     }
 
     std::pair<bool, std::string> Game::loadResources()
@@ -191,7 +174,7 @@ namespace
     void Game::reset()
     {
         // randomize which bird texture to use
-        auto birdTextures = [this]() -> std::tuple<const sf::Texture&,
+        auto randomBirdTextures = [this]() -> std::tuple<const sf::Texture&,
                                                          const sf::Texture&,
                                                          const sf::Texture&> {
             auto p = std::rand() % 100;
@@ -207,9 +190,15 @@ namespace
             return { m_gameTexturesLookup.getResource("TEXTURE_YELLOW_BIRD_FLAP_DOWN"),
                      m_gameTexturesLookup.getResource("TEXTURE_YELLOW_BIRD_FLAP_MID"),
                      m_gameTexturesLookup.getResource("TEXTURE_YELLOW_BIRD_FLAP_UP") };
-        } ();
-        m_bird = Bird(std::get<0>(birdTextures), std::get<1>(birdTextures), std::get<2>(birdTextures));
-        m_bird.reset(BIRD_STARTING_X, m_renderWindow.getSize().y / 2);
+        };
+
+        // every organism of the population gets its own bird
+        const auto& organisms = m_trainer.getPopulation().organisms;
+        m_birds.clear();
+        for(std::size_t i = 0; i < organisms.size(); ++i) {
+            auto birdTextures = randomBirdTextures();
+            m_birds.emplace_back(std::get<0>(birdTextures), std::get<1>(birdTextures), std::get<2>(birdTextures));
+        }
 
         // randomize the obstacles
         const auto& obstacleTexture = [this]() -> const sf::Texture& {
@@ -238,19 +227,15 @@ namespace
 
         // reset the score and flags
         m_gameOverFlashAlpha = 255;
-        m_score = 0;
         m_scoreRender.setScore(0);
-        m_currentObstacleIndex = 0;
-        m_gameStart = false;
-        m_dead = false;
 
         // create randomized obstacles
-        auto startingX = 500.f;
-        m_obstacles.clear();
-        for(auto i = 0; i < 10; ++i) {
-            m_obstacles.push_back(createRandomObstaclePair(startingX));
-            startingX += 250.f;
-        }
+        m_evaluator.reset(organisms, m_trainer.createCourse());
+        m_evaluator.setLimits(m_trainer.getEpisodeLimits());
+        m_evaluator.setDecisionInterval(m_trainer.getDecisionInterval());
+        m_step = 0;
+
+        m_renderWindow.setTitle("FlappyBird++ AI : Generation " + std::to_string(m_trainer.getGeneration()));
     }
 
     void Game::run()
@@ -259,7 +244,7 @@ namespace
 
         reset();
 
-        static constexpr float timeStep = 1.0f / 128.f;
+        static constexpr float timeStep = Simulation::TIME_STEP;
         sf::Clock clock;
 
         // Fixed time step from Glen Fiedler's "Fix Your TimeStep"
@@ -289,18 +274,21 @@ namespace
         m_renderWindow.draw(m_background);
         drawForeground(alpha, windowHeight);
         drawObstacle(alpha);
-        m_bird.draw(m_renderWindow, alpha);
+        for(std::size_t i = 0; i < m_birds.size(); ++i) {
+            if(!m_simulation.isDead(i) || m_simulation.isDead())
+                m_birds[i].draw(m_renderWindow, m_simulation.getBirds(), i, alpha);
+        }
 
         if(m_debugMode)
             drawDebug(fps);
-        if(m_dead) {
+        if(m_simulation.isDead()) {
             if(m_gameOverFlashAlpha == 0)
                 m_renderWindow.draw(m_gameOver);
             else {
                 m_gameOverFlash.setFillColor(sf::Color(255, 255, 255, m_gameOverFlashAlpha));
                 m_renderWindow.draw(m_gameOverFlash);
             }
-        } else if(!m_gameStart)
+        } else if(!m_simulation.isStarted())
             m_renderWindow.draw(m_gameStartMessage);
         m_scoreRender.draw(m_renderWindow);
     }
@@ -318,19 +306,22 @@ namespace
 
     void Game::drawObstacle(float alpha)
     {
-        for(const auto& [upperObstacle, lowerObstacle] : m_obstacles) {
-            auto upperRenderPosition = linearInterpolation(upperObstacle.oldPosition, upperObstacle.position, alpha);
-            auto lowerRenderPosition = linearInterpolation(lowerObstacle.oldPosition, lowerObstacle.position, alpha);
+        for(std::size_t i = 0; i < Simulation::OBSTACLE_COUNT; ++i) {
+            const auto& [upperObstacle, lowerObstacle] = m_simulation.getObstacle(i);
+            auto upperRenderPosition = linearInterpolation(toFloat(upperObstacle.oldPosition), toFloat(upperObstacle.position), alpha);
+            auto lowerRenderPosition = linearInterpolation(toFloat(lowerObstacle.oldPosition), toFloat(lowerObstacle.position), alpha);
+            auto upperDimension = toFloat(upperObstacle.dimension);
+            auto lowerDimension = toFloat(lowerObstacle.dimension);
 
             upperRenderPosition.x = std::roundf(upperRenderPosition.x + 2.f);
             lowerRenderPosition.x = std::roundf(lowerRenderPosition.x + 2.f);
 
-            m_obstacle.setSize(sf::Vector2f(upperObstacle.dimension.x - 4, upperObstacle.dimension.y));
+            m_obstacle.setSize(sf::Vector2f(upperDimension.x - 4, upperDimension.y));
             m_obstacle.setPosition(upperRenderPosition);
 
             m_renderWindow.draw(m_obstacle);
 
-            m_obstacle.setSize(sf::Vector2f(lowerObstacle.dimension.x - 4, lowerObstacle.dimension.y));
+            m_obstacle.setSize(sf::Vector2f(lowerDimension.x - 4, lowerDimension.y));
             m_obstacle.setPosition(lowerRenderPosition);
             m_renderWindow.draw(m_obstacle);
 
@@ -339,7 +330,7 @@ namespace
             upperEndRenderPosition.x = std::roundf(upperEndRenderPosition.x);
 
             m_obstacleUpperEnd.setPosition(upperEndRenderPosition);
-            m_obstacleUpperEnd.move(0, upperObstacle.dimension.y - 24);
+            m_obstacleUpperEnd.move(0, upperDimension.y - 24);
             m_renderWindow.draw(m_obstacleUpperEnd);
 
             auto lowerEndRenderPosition = lowerRenderPosition;
@@ -361,25 +352,32 @@ namespace
 
         sf::RectangleShape collider;
 
-        // draw the bird collider
-        {
-            const auto& birdOOBB = m_bird.getOOBB();
-            collider.setSize(sf::Vector2f(birdOOBB.width, birdOOBB.height));
-            collider.setPosition(birdOOBB.left, birdOOBB.top);
-            collider.setFillColor(sf::Color(255, 0, 0, 128));
+        // draw the bird colliders
+        collider.setFillColor(sf::Color(255, 0, 0, 128));
+        for(std::size_t i = 0; i < m_simulation.getBirdCount(); ++i) {
+            if(m_simulation.isDead(i))
+                continue;
+
+            auto birdOOBB = m_simulation.getBirds().getOOBB(i);
+            collider.setSize(sf::Vector2f(toFloat(birdOOBB.width), toFloat(birdOOBB.height)));
+            collider.setPosition(toFloat(birdOOBB.left), toFloat(birdOOBB.top));
             m_renderWindow.draw(collider);
         }
 
         // draw the foreground collider
         {
-            collider.setSize(sf::Vector2f(m_foregroundOOBB.width, m_foregroundOOBB.height));
-            collider.setPosition(m_foregroundOOBB.left, m_foregroundOOBB.top);
+            const auto& foregroundOOBB = m_simulation.getForegroundOOBB();
+            collider.setSize(sf::Vector2f(toFloat(foregroundOOBB.width), toFloat(foregroundOOBB.height)));
+            collider.setPosition(toFloat(foregroundOOBB.left), toFloat(foregroundOOBB.top));
             m_renderWindow.draw(collider);
         }
 
-        // draw the bird position
-        {
-            auto birdPosition = m_bird.getPosition();
+        // draw the bird position of the first bird still alive
+        for(std::size_t i = 0; i < m_simulation.getBirdCount(); ++i) {
+            if(m_simulation.isDead(i))
+                continue;
+
+            auto birdPosition = m_simulation.getBirds().getPosition(i);
             std::string birdPositionStr = "[";
             birdPositionStr += std::to_string(static_cast<int>(birdPosition.x));
             birdPositionStr += ", ";
@@ -388,21 +386,23 @@ namespace
             debugText.setString(birdPositionStr);
             debugText.setPosition(birdPosition - sf::Vector2f(debugText.getLocalBounds().width / 2.f, -15));
             m_renderWindow.draw(debugText);
+            break;
         }
 
         // draw the obstacle positions
-        for(const auto& [upperObstacle, lowerObstacle] : m_obstacles) {
-            auto upperObstaclePosition = upperObstacle.position;
-            upperObstaclePosition.y += upperObstacle.dimension.y;
-            auto lowerObstaclePosition = lowerObstacle.position;
+        for(std::size_t i = 0; i < Simulation::OBSTACLE_COUNT; ++i) {
+            const auto& [upperObstacle, lowerObstacle] = m_simulation.getObstacle(i);
+            auto upperObstaclePosition = toFloat(upperObstacle.position);
+            upperObstaclePosition.y += toFloat(upperObstacle.dimension.y);
+            auto lowerObstaclePosition = toFloat(lowerObstacle.position);
 
             // draw colliders
-            collider.setSize(upperObstacle.dimension);
-            collider.setPosition(upperObstacle.position);
+            collider.setSize(toFloat(upperObstacle.dimension));
+            collider.setPosition(toFloat(upperObstacle.position));
             m_renderWindow.draw(collider);
 
-            collider.setSize(lowerObstacle.dimension);
-            collider.setPosition(lowerObstacle.position);
+            collider.setSize(toFloat(lowerObstacle.dimension));
+            collider.setPosition(toFloat(lowerObstacle.position));
             m_renderWindow.draw(collider);
 
             std::string obstaclePositionStr = "[";
@@ -445,92 +445,30 @@ namespace
 
     void Game::update(float dt)
     {
-        if(!m_dead) {
-            m_bird.updateAnimation(dt);
-            if(m_gameStart) {
-                m_bird.update(dt);
-
-                const auto& birdOOBB = m_bird.getOOBB();
-                if((birdOOBB.intersects(m_foregroundOOBB) /*||
-                   birdOOBB.top <= birdOOBB.height / 2.f*/)
-#ifndef NDEBUG
-                        && !m_godMode
-#endif // NDEBUG
-                   ) {
-                    m_dead = true;
-                    m_gameStart = false;
-                    m_bird.preReset();
-                    m_bird.resetUpForce();
-
-                    for(auto& [ob1, ob2] : m_obstacles) {
-                        ob1.preReset();
-                        ob2.preReset();
-                    }
-                    for(auto& [newPos, oldPos] : m_foregroundPositions) {
-                        oldPos = newPos;
-                    }
+        if(!m_simulation.isDead()) {
+            for(auto& bird : m_birds) {
+                bird.updateAnimation(dt);
+            }
 
+            // the foreground only stops once the episode is over, when the last
+            // birds crashed or a limit was reached
+            auto events = m_evaluator.step();
+            if(m_simulation.isDead()) {
+                for(auto& [newPos, oldPos] : m_foregroundPositions) {
+                    oldPos = newPos;
+                }
+
+                if(events & Simulation::STEP_EVENT_DIED) {
                     m_hitSound.play();
                     m_dieSound.play();
-
-                } else {
-                    for(std::size_t i = 0, isize = m_obstacles.size(); i < isize;) {
-                        auto& [upperObstacle, lowerObstacle] = m_obstacles[i];
-
-                        upperObstacle.oldPosition = upperObstacle.position;
-                        upperObstacle.position.x -= 100.f * dt;
-                        lowerObstacle.oldPosition = lowerObstacle.position;
-                        lowerObstacle.position.x -= 100.f * dt;
-
-                        if(upperObstacle.position.x <= -52.f) {
-                            const auto& lastObstacle = m_obstacles.back();
-                            auto difficultyDistance = getDifficultyDistance();
-                            auto newObstacle = createRandomObstaclePair(lastObstacle.first.position.x + difficultyDistance);
-
-                            m_obstacles.erase(m_obstacles.begin() + i);
-                            m_obstacles.push_back(newObstacle);
-                            --m_currentObstacleIndex;
-                        } else {
-                                sf::FloatRect upperObstacleOOBB(upperObstacle.position, upperObstacle.dimension);
-                                sf::FloatRect lowerObstacleOOBB(lowerObstacle.position, lowerObstacle.dimension);
-                                if((birdOOBB.intersects(upperObstacleOOBB) || birdOOBB.intersects(lowerObstacleOOBB))
-#ifndef NDEBUG
-                                       // godmode available on debug mode
-                                       && !m_godMode
-#endif // NDEBUG
-                                   ) {
-                                    m_dead = true;
-                                    m_gameStart = false;
-                                    m_bird.preReset();
-                                    m_bird.resetUpForce();
-
-                                    for(auto& [ob1, ob2] : m_obstacles) {
-                                        ob1.preReset();
-                                        ob2.preReset();
-                                    }
-                                    for(auto& [newPos, oldPos] : m_foregroundPositions) {
-                                        oldPos = newPos;
-                                    }
-
-                                    m_hitSound.play();
-                                    m_dieSound.play();
-                                    break;
-                                }
-                            ++i;
-                        }
-                    }
-
-                    const auto& currentObstacle = m_obstacles[m_currentObstacleIndex];
-                    if(currentObstacle.first.position.x <= BIRD_STARTING_X - 17 - 52) {
-                        ++m_currentObstacleIndex;
-                        ++m_score;
-                        m_scoreRender.setScore(m_score);
-                        m_pointSound.play();
-                    }
                 }
             }
+            if(events & Simulation::STEP_EVENT_SCORED) {
+                m_scoreRender.setScore(m_simulation.getScore());
+                m_pointSound.play();
+            }
 
-            if(!m_dead) {
+            if(!m_simulation.isDead()) {
                 for(auto& [newPos, oldPos] : m_foregroundPositions) {
                     oldPos = newPos;
                     newPos -= 100.f * dt;
@@ -557,76 +495,47 @@ namespace
                     m_gameOverFlashAlpha -= au;
             }
 
-            const auto& birdOOBB = m_bird.getOOBB();
-            if(!birdOOBB.intersects(m_foregroundOOBB))
-                m_bird.update(dt);
-            else
-                m_bird.preReset();
+            m_simulation.step();
         }
     }
 
     void Game::handleInput()
     {
-        if(!m_dead) {
-            if(!m_gameStart) {
-              m_gameStart = true;
+        if(!m_simulation.isDead()) {
+            if(!m_simulation.isStarted()) {
+              m_simulation.start();
             } else {
-              const auto& bird_pos = m_bird.getPosition();
-
-              auto obstacle_index = 0;
-              for(size_t i = 0; i < m_obstacles.size(); ++i) {
-                if(bird_pos.x < m_obstacles[i].first.position.x + m_obstacles[i].first.dimension.x + 25) {
-                  obstacle_index = i;
-                  break;
-                }
+              if(m_evaluator.think() > 0) {
+                m_wingSound.play();
               }
 
-              const auto& organism = m_population->organisms[m_currentOrganismIndex];
-              const auto& upper_ob_pos = m_obstacles[obstacle_index].first.position;
-              const auto& upper_ob_dim = m_obstacles[obstacle_index].first.dimension;
-              const auto& lower_ob_pos = m_obstacles[obstacle_index].second.position;
-
-              double input[4];
-              input[0] = 1.0;
-              input[1] = (lower_ob_pos.x - bird_pos.x) / 1000.0;
-              input[2] = ((upper_ob_pos.y + upper_ob_dim.y)  - bird_pos.y) / 1000.0;
-              input[3] = (lower_ob_pos.y - bird_pos.y) / 1000.0;
-
-              std::cout << input[1] << " " << input[2] << " " << input[3] << std::endl;
-
-              auto* net = organism->net;
-              net->load_sensors(&input[0]);
-              net->activate();
-
-              double res = (*net->outputs.begin())->activation;
-              std::cout << res << std::endl;
-              if(res > 0.5) {
-                m_bird.applyUpForce();
-                m_wingSound.play();
-                m_upClicked = true;
-              } else {
-                if(m_upClicked) {
-                  m_upClicked = false;
-                  m_bird.resetUpForce();
+              if(m_telemetry.shouldTraceStep(++m_step)) {
+                for(std::size_t i = 0; i < m_simulation.getBirdCount(); ++i) {
+                  if(!m_simulation.isDead(i)) {
+                    auto input = m_simulation.getSensorInputs(i);
+                    m_telemetry.log(Telemetry::LEVEL_TRACE, "bird_step", m_step,
+                                    { { "bird", static_cast<double>(i) },
+                                      { "sensor1", input[1] },
+                                      { "sensor2", input[2] },
+                                      { "sensor3", input[3] },
+                                      { "output", m_evaluator.getOutput(i) } });
+                    break;
+                  }
                 }
               }
             }
         } else {
-          m_population->organisms[m_currentOrganismIndex]->fitness = m_score * 10;
-          for(auto& specie : m_population->species) {
-            specie->compute_average_fitness();
-            specie->compute_max_fitness();
-          }
-
-          m_renderWindow.setTitle("FlappyBird++ AI : Generation " +
-                                  std::to_string(m_generation) +
-                                  " Organism " +
-                                  std::to_string(m_currentOrganismIndex));
-            ++m_currentOrganismIndex;
-            if(m_currentOrganismIndex > m_population->organisms.size()) {
-                m_currentOrganismIndex = 0;
-                m_population->epoch(++m_generation);
+            // the whole generation has been played, move on to the next one
+            if(m_telemetry.isEnabled(Telemetry::LEVEL_INFO)) {
+                m_telemetry.log(Telemetry::LEVEL_INFO, "generation", m_step,
+                                { { "generation", static_cast<double>(m_trainer.getGeneration()) },
+                                  { "score", static_cast<double>(m_simulation.getScore()) },
+                                  { "birds", static_cast<double>(m_simulation.getBirdCount()) },
+                                  { "limit", m_evaluator.hasReachedLimit() ? 1.0 : 0.0 },
+                                  { "activations", static_cast<double>(m_evaluator.getActivations()) } });
             }
+            m_evaluator.writeFitness();
+            m_trainer.nextGeneration();
 
             reset();
             m_swooshSound.play();
@@ -640,16 +549,18 @@ namespace
                 break;
             case sf::Event::KeyPressed:
                 if(event.key.code == sf::Keyboard::Space) {
-                    if(m_gameStart && !m_dead) {
-                        m_bird.applyUpForce();
+                    if(m_simulation.isStarted() && !m_simulation.isDead()) {
+                        for(std::size_t i = 0; i < m_simulation.getBirdCount(); ++i) {
+                            m_simulation.flap(i);
+                        }
                         m_wingSound.play();
                     }
                 } else if(event.key.code == sf::Keyboard::Enter) {
-                    if(m_dead && m_gameOverFlashAlpha == 0) {
+                    if(m_simulation.isDead() && m_gameOverFlashAlpha == 0) {
                         reset();
                         m_swooshSound.play();
-                    } else if(!m_gameStart) {
-                        m_gameStart = true;
+                    } else if(!m_simulation.isStarted()) {
+                        m_simulation.start();
                         m_swooshSound.play();
                     }
                 }
@@ -657,8 +568,11 @@ namespace
                 break;
             case sf::Event::KeyReleased:
                 if(event.key.code == sf::Keyboard::Space) {
-                    if(!m_dead)
-                        m_bird.resetUpForce();
+                    if(!m_simulation.isDead()) {
+                        for(std::size_t i = 0; i < m_simulation.getBirdCount(); ++i) {
+                            m_simulation.releaseFlap(i);
+                        }
+                    }
                 } else if(event.key.code == sf::Keyboard::BackSpace)
                     m_enteredText.clear();
                 break;
@@ -669,6 +583,7 @@ namespace
 #ifndef NDEBUG
                 else if(m_enteredText == "godmode") {
                     m_godMode = !m_godMode;
+                    m_simulation.setInvincible(m_godMode);
                 }
 #endif // NDEBUG
                 if(m_enteredText.size() >= 9)
@@ -679,24 +594,4 @@ namespace
             }
         }
     }
-
-    std::pair<Obstacle, Obstacle> Game::createRandomObstaclePair(float startingPositionX)
-    {
-        auto windowHeight = m_renderWindow.getSize().y;
-        auto maxHeight = static_cast<int>(windowHeight * 0.60f) - static_cast<int>(FOREGROUND_Y);
-        auto minHeight = 50;
-
-        auto upperObstacleHeight = minHeight + (std::rand() % maxHeight);
-        auto lowerObstacleHeight = windowHeight - upperObstacleHeight - 120 - FOREGROUND_Y;
-
-        Obstacle upperObstacle(startingPositionX, 0, 52, upperObstacleHeight);
-        Obstacle lowerObstacle(startingPositionX, windowHeight - lowerObstacleHeight - FOREGROUND_Y, 52, lowerObstacleHeight);
-
-        return { upperObstacle, lowerObstacle };
-    }
-
-    float Game::getDifficultyDistance() const
-    {
-        return std::max(250.f - (m_score * 2), 150.f);
-    }
 }
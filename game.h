@@ -19,12 +19,14 @@
 
 #include <SFML/Audio.hpp>
 #include <SFML/Graphics.hpp>
-#include "neat/population.h"
+#include "batchevaluator.h"
 #include "bird.h"
 #include "fps.h"
-#include "obstacle.h"
 #include "resourcelookup.h"
 #include "score.h"
+#include "simulation.h"
+#include "telemetry.h"
+#include "trainer.h"
 
 namespace flappybirdplusplus
 {
@@ -39,14 +41,18 @@ namespace flappybirdplusplus
         void reset();
         void run();
 
+        // closed until main opens it, the per step traces follow the first living bird
+        Telemetry& getTelemetry() { return m_telemetry; }
+
+        // the limits of the episodes from the next reset on
+        void setEpisodeLimits(const EpisodeLimits& limits) { m_trainer.setEpisodeLimits(limits); }
+        void setDecisionInterval(const DecisionInterval& interval) { m_trainer.setDecisionInterval(interval); }
+
     private:
         void draw(float alpha, FPS& fps);
         void update(float dt);
         void handleInput();
 
-        std::pair<Obstacle, Obstacle> createRandomObstaclePair(float startingPositionX);
-        float getDifficultyDistance() const;
-
         void drawForeground(float alpha, unsigned int windowHeight);
         void drawObstacle(float alpha);
         void drawDebug(FPS& fps);
@@ -55,14 +61,15 @@ namespace flappybirdplusplus
         ResourceLookup<sf::Font>                    m_gameFontsLookup;
         ResourceLookup<sf::SoundBuffer>             m_gameSoundLookup;
 
-        std::unique_ptr<NEAT::Genome>               m_startGenome;
-        std::unique_ptr<NEAT::Population>           m_population;
-        bool                                        m_upClicked = false;
-        size_t                                      m_currentOrganismIndex = 0;
-        size_t                                      m_generation = 1;
+        Trainer                                     m_trainer;
+        Simulation                                  m_simulation;
+        BatchEvaluator                              m_evaluator;
         sf::RenderWindow                            m_renderWindow;
 
-        Bird                                        m_bird;
+        Telemetry                                   m_telemetry;
+        std::uint64_t                               m_step;
+
+        std::vector<Bird>                           m_birds;
         Score                                       m_scoreRender;
 
         sf::Sound                                   m_dieSound;
@@ -79,24 +86,15 @@ namespace flappybirdplusplus
 
         sf::RectangleShape                          m_gameOverFlash;
 
-        std::vector<std::pair<Obstacle, Obstacle>>  m_obstacles;
         std::vector<std::pair<float, float>>        m_foregroundPositions;
-        sf::FloatRect                               m_foregroundOOBB;
 
         sf::Sprite                                  m_gameOver;
         sf::Sprite                                  m_gameStartMessage;
 
         std::string                                 m_enteredText;
 
-        std::size_t                                 m_currentObstacleIndex;
-
-        unsigned int                                m_score;
-
         unsigned char                               m_gameOverFlashAlpha;
 
-        bool                                        m_gameStart;
-        bool                                        m_dead;
-
         bool                                        m_debugMode;
 
 #ifndef NDEBUG
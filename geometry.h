@@ -0,0 +1,49 @@
+/**
+ * FlappyBird++
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ **/
+#ifndef GEOMETRY_H
+#define GEOMETRY_H
+
+#include <algorithm>
+#include "fixedpoint.h"
+
+namespace flappybirdplusplus
+{
+    // axis aligned bounding box, same semantics as sf::FloatRect
+    // but in fixed point and usable without linking against SFML graphics
+    struct AABB
+    {
+        AABB() : left(0), top(0), width(0), height(0) {}
+        AABB(Fixed l, Fixed t, Fixed w, Fixed h) : left(l), top(t), width(w), height(h) {}
+
+        bool intersects(const AABB& other) const
+        {
+            auto interLeft = std::max(left, other.left);
+            auto interTop = std::max(top, other.top);
+            auto interRight = std::min(left + width, other.left + other.width);
+            auto interBottom = std::min(top + height, other.top + other.height);
+
+            return interLeft < interRight && interTop < interBottom;
+        }
+
+        Fixed left;
+        Fixed top;
+        Fixed width;
+        Fixed height;
+    };
+}
+
+#endif // GEOMETRY_H
@@ -14,34 +14,147 @@
  * You should have received a copy of the GNU General Public License
  * along with this program.  If not, see <https://www.gnu.org/licenses/>.
  **/
-#ifdef __linux__
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
-#elif _WIN32
+#ifdef _WIN32
 #include <windows.h>
 #endif
 #include "game.h"
+#include "simulation.h"
+#include "neat/neat.h"
+#include "neat/profiler.h"
+#include "trainer.h"
 
 #ifdef __linux__
-#define MAIN_FUNCTION int main()
+#define MAIN_FUNCTION int main(int argc, char** argv)
+#define ARGC argc
+#define ARGV argv
 #elif _WIN32
 #define MAIN_FUNCTION int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE, LPSTR pCmdLine, int nCmdShow)
+#define ARGC __argc
+#define ARGV __argv
 #endif
 
 static constexpr unsigned int DEFAULT_WINDOW_WIDTH = 400;
 static constexpr unsigned int DEFAULT_WINDOW_HEIGHT = 600;
+static constexpr std::size_t DEFAULT_HEADLESS_GENERATIONS = 100;
 
 void showMessage(std::string msg, std::string title);
+const char* findArgument(int argc, char** argv, const char* name, bool hasValue);
+bool checkPhysics();
+flappybirdplusplus::EpisodeLimits parseEpisodeLimits(int argc, char** argv);
+flappybirdplusplus::DecisionInterval parseDecisionInterval(int argc, char** argv);
 
 MAIN_FUNCTION
 {
     std::srand(std::time(nullptr));
+
+    // exact, rational, table or float, see NEAT::set_sigmoid_kernel
+    if(auto value = findArgument(ARGC, ARGV, "--sigmoid", true); value) {
+        NEAT::sigmoidkernel kernel;
+        if(!NEAT::sigmoid_kernel_from_name(value, kernel)) {
+            showMessage("Unknown sigmoid kernel \"" + std::string(value) + "\"!", "Error");
+            return -1;
+        }
+        NEAT::set_sigmoid_kernel(kernel);
+    }
+
+    // a Chrome trace of the epoch phases, written when the program ends.
+    // Needs a build with NEAT_PROFILING defined
+    const char* traceFile = findArgument(ARGC, ARGV, "--trace", true);
+#ifdef NEAT_PROFILING
+    if(traceFile)
+        NEAT::Profiler::startTrace();
+#else
+    if(traceFile) {
+        showMessage("--trace needs a build with NEAT_PROFILING defined!", "Error");
+        return -1;
+    }
+#endif
+
+    // replays scripted games and compares them against the recorded ones,
+    // a build that fails this plays different games than every other build
+    if(findArgument(ARGC, ARGV, "--check-physics", false))
+        return checkPhysics() ? 0 : 1;
+
+    // train without a window as fast as possible, e.g.
+    // FlappyBirdPlusPlusAI --headless --generations 500 --threads 8 --sigmoid table --seed 42 --checkpoint-every 10
+    if(findArgument(ARGC, ARGV, "--headless", false)) {
+        auto generations = DEFAULT_HEADLESS_GENERATIONS;
+        if(auto value = findArgument(ARGC, ARGV, "--generations", true); value)
+            generations = std::strtoul(value, nullptr, 10);
+
+        // every hardware thread by default
+        std::size_t threads = 0;
+        if(auto value = findArgument(ARGC, ARGV, "--threads", true); value)
+            threads = std::strtoul(value, nullptr, 10);
+
+        // a run is repeated by passing the seed it printed
+        auto seed = NEAT::RNG::makeSeed();
+        if(auto value = findArgument(ARGC, ARGV, "--seed", true); value)
+            seed = std::strtoull(value, nullptr, 10);
+        std::cout << "Seed " << seed << std::endl;
+
+        auto kernel = NEAT::get_sigmoid_kernel();
+        std::cout << "Sigmoid " << NEAT::sigmoid_kernel_name(kernel) << " max error "
+                  << NEAT::sigmoid_max_error(kernel, 4.924273) << std::endl;
+
+        flappybirdplusplus::Trainer trainer(DEFAULT_WINDOW_WIDTH, DEFAULT_WINDOW_HEIGHT, threads, seed);
+        if(auto value = findArgument(ARGC, ARGV, "--checkpoint-every", true); value)
+            trainer.setCheckpointInterval(std::strtoul(value, nullptr, 10));
+        trainer.setEpisodeLimits(parseEpisodeLimits(ARGC, ARGV));
+        trainer.setDecisionInterval(parseDecisionInterval(ARGC, ARGV));
+
+        // species share one innovation list while reproducing, the numbering
+        // then depends on the thread timing and the seed no longer repeats a run
+        if(findArgument(ARGC, ARGV, "--nondeterministic", false))
+            trainer.getPopulation().deterministic_reproduction = false;
+        trainer.run(generations);
+
+        if(traceFile && !NEAT::Profiler::writeTrace(traceFile)) {
+            showMessage("Cannot write trace \"" + std::string(traceFile) + "\"!", "Error");
+            return -1;
+        }
+
+        return 0;
+    }
+
     flappybirdplusplus::Game game(DEFAULT_WINDOW_WIDTH, DEFAULT_WINDOW_HEIGHT);
     if(auto p = game.loadResources(); !p.first) {
         showMessage("Cannot load resource \"" + p.second + "\"!", "Error");
         return -1;
     }
+    game.setEpisodeLimits(parseEpisodeLimits(ARGC, ARGV));
+    game.setDecisionInterval(parseDecisionInterval(ARGC, ARGV));
+
+    // events of the game as JSON lines, e.g.
+    // FlappyBirdPlusPlusAI --telemetry telemetry.jsonl --telemetry-level trace --telemetry-every 16
+    if(auto value = findArgument(ARGC, ARGV, "--telemetry", true); value) {
+        auto level = flappybirdplusplus::Telemetry::LEVEL_INFO;
+        if(auto name = findArgument(ARGC, ARGV, "--telemetry-level", true);
+           name && !flappybirdplusplus::Telemetry::levelFromName(name, level)) {
+            showMessage("Unknown telemetry level \"" + std::string(name) + "\"!", "Error");
+            return -1;
+        }
+
+        // the bird of every step by default
+        std::uint64_t every = 1;
+        if(auto n = findArgument(ARGC, ARGV, "--telemetry-every", true); n)
+            every = std::strtoull(n, nullptr, 10);
+
+        if(!game.getTelemetry().open(value, level, every)) {
+            showMessage("Cannot open \"" + std::string(value) + "\"!", "Error");
+            return -1;
+        }
+    }
     game.run();
 
+    if(traceFile && !NEAT::Profiler::writeTrace(traceFile)) {
+        showMessage("Cannot write trace \"" + std::string(traceFile) + "\"!", "Error");
+        return -1;
+    }
+
     return 0;
 }
 
@@ -53,3 +166,97 @@ void showMessage(std::string msg, std::string title)
     MessageBox(0, msg.c_str(), title.c_str(), 0);
 #endif
 }
+
+const char* findArgument(int argc, char** argv, const char* name, bool hasValue)
+{
+    for(auto i = 1; i < argc; ++i) {
+        if(std::strcmp(argv[i], name) == 0) {
+            if(!hasValue)
+                return argv[i];
+
+            return i + 1 < argc ? argv[i + 1] : nullptr;
+        }
+    }
+
+    return nullptr;
+}
+
+// --max-steps, --max-score and --max-seconds end an episode although birds
+// are still flying, 0 turns a limit off. 10 minutes of game time by default
+flappybirdplusplus::EpisodeLimits parseEpisodeLimits(int argc, char** argv)
+{
+    flappybirdplusplus::EpisodeLimits limits;
+    limits.maxSteps = flappybirdplusplus::Trainer::MAX_EPISODE_STEPS;
+    if(auto value = findArgument(argc, argv, "--max-steps", true); value)
+        limits.maxSteps = std::strtoul(value, nullptr, 10);
+    if(auto value = findArgument(argc, argv, "--max-score", true); value)
+        limits.maxScore = std::strtoul(value, nullptr, 10);
+    if(auto value = findArgument(argc, argv, "--max-seconds", true); value)
+        limits.maxSeconds = std::strtod(value, nullptr);
+
+    return limits;
+}
+
+// --decision-interval asks the networks every that many ticks, and
+// --decision-distance every tick again within that many pixels of a pipe
+flappybirdplusplus::DecisionInterval parseDecisionInterval(int argc, char** argv)
+{
+    flappybirdplusplus::DecisionInterval interval;
+    if(auto value = findArgument(argc, argv, "--decision-interval", true); value)
+        interval.ticks = std::strtoul(value, nullptr, 10);
+    if(auto value = findArgument(argc, argv, "--decision-distance", true); value)
+        interval.nearDistance = std::atoi(value);
+
+    return interval;
+}
+
+bool checkPhysics()
+{
+    struct Trajectory
+    {
+        const char*     name;
+        std::uint32_t   courseSeed;
+        std::size_t     birdCount;
+        bool            invincible;
+        std::size_t     steps;
+        std::uint64_t   checksum;
+    };
+
+    // recorded with the fixed point simulation. Each bird flaps once it sinks
+    // to its own height above the lower obstacle and now and then strays,
+    // so the flock dies out bird by bird
+    static constexpr Trajectory trajectories[] = {
+        { "flock", 12345, 16, false, 20000, 12678104623401822114ull },
+        { "invincible", 777, 2, true, 40000, 14368538944479421934ull }
+    };
+
+    auto passed = true;
+    for(const auto& trajectory : trajectories) {
+        flappybirdplusplus::Simulation simulation(DEFAULT_WINDOW_WIDTH, DEFAULT_WINDOW_HEIGHT);
+        simulation.setInvincible(trajectory.invincible);
+        simulation.reset(trajectory.birdCount, trajectory.courseSeed);
+        simulation.start();
+
+        // every step goes into the checksum, so the first diverging tick fails it
+        std::uint64_t checksum = 0;
+        std::size_t step = 0;
+        for(; step < trajectory.steps && !simulation.isDead(); ++step) {
+            for(std::size_t bird = 0; bird < trajectory.birdCount; ++bird) {
+                if(!simulation.isDead(bird)) {
+                    auto lowerGap = simulation.getSensorInputs(bird)[3];
+                    auto stray = (step + 37 * bird) % (300 + 20 * bird) < 12;
+                    simulation.control(lowerGap < 0.02 + 0.004 * bird || stray, bird);
+                }
+            }
+            simulation.step();
+            checksum = checksum * 31 + simulation.getChecksum();
+        }
+
+        auto matches = checksum == trajectory.checksum;
+        passed = passed && matches;
+        std::cout << trajectory.name << ": " << step << " steps, score " << simulation.getScore()
+                  << ", checksum " << checksum << (matches ? " ok" : " MISMATCH") << std::endl;
+    }
+
+    return passed;
+}
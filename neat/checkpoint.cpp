@@ -0,0 +1,442 @@
+#include "checkpoint.h"
+
+#include <cstring>
+#include <fstream>
+#include <unordered_map>
+#include "gene.h"
+#include "genome.h"
+#include "innovation.h"
+#include "nnode.h"
+#include "organism.h"
+#include "population.h"
+#include "profiler.h"
+#include "species.h"
+#include "trait.h"
+
+namespace NEAT
+{
+  class Checkpoint::Writer
+  {
+  public:
+    explicit Writer(std::vector<char>& buffer) : m_buffer(buffer) {}
+
+    template<class T>
+    void write(const T& value)
+    {
+      auto offset = m_buffer.size();
+      m_buffer.resize(offset + sizeof(T));
+      std::memcpy(m_buffer.data() + offset, &value, sizeof(T));
+    }
+
+    void write(const void* data, std::size_t size)
+    {
+      auto offset = m_buffer.size();
+      m_buffer.resize(offset + size);
+      std::memcpy(m_buffer.data() + offset, data, size);
+    }
+
+  private:
+    std::vector<char>&  m_buffer;
+  };
+
+  class Checkpoint::Reader
+  {
+  public:
+    Reader(const char* data, std::size_t size) : m_data(data), m_size(size), m_position(0), m_good(true) {}
+
+    template<class T>
+    T read()
+    {
+      T value{};
+      read(&value, sizeof(T));
+      return value;
+    }
+
+    void read(void* data, std::size_t size)
+    {
+      if(!m_good || m_size - m_position < size) {
+        m_good = false;
+        return;
+      }
+
+      std::memcpy(data, m_data + m_position, size);
+      m_position += size;
+    }
+
+    // counts are checked against what is left, so a corrupt count
+    // cannot make the loader allocate the world
+    std::uint32_t readCount(std::size_t minimumElementSize)
+    {
+      auto count = read<std::uint32_t>();
+      if(m_good && count > (m_size - m_position) / minimumElementSize) {
+        m_good = false;
+      }
+      return m_good ? count : 0;
+    }
+
+    bool good() const { return m_good; }
+
+  private:
+    const char*   m_data;
+    std::size_t   m_size;
+    std::size_t   m_position;
+    bool          m_good;
+  };
+
+  // traits are referenced by their position in the genome, 0 is none
+  static std::uint32_t traitIndex(const Genome& genome, const Trait* trait)
+  {
+    for(std::size_t i = 0; i < genome.traits.size(); ++i) {
+      if(genome.traits[i] == trait) {
+        return static_cast<std::uint32_t>(i + 1);
+      }
+    }
+    return 0;
+  }
+
+  void Checkpoint::writeGenome(Writer& writer, const Genome& genome)
+  {
+    writer.write<std::int32_t>(genome.genome_id);
+
+    writer.write<std::uint32_t>(static_cast<std::uint32_t>(genome.traits.size()));
+    for(const auto* trait : genome.traits) {
+      writer.write<std::int32_t>(trait->trait_id);
+      writer.write(trait->params, sizeof(trait->params));
+    }
+
+    std::unordered_map<const NNode*, std::uint32_t> nodeIndices;
+    writer.write<std::uint32_t>(static_cast<std::uint32_t>(genome.nodes.size()));
+    for(std::size_t i = 0; i < genome.nodes.size(); ++i) {
+      const auto* node = genome.nodes[i];
+      nodeIndices[node] = static_cast<std::uint32_t>(i);
+      writer.write<std::int32_t>(node->node_id);
+      writer.write<std::uint32_t>(traitIndex(genome, node->nodetrait));
+      writer.write<std::int32_t>(node->trait_id);
+      writer.write<std::uint8_t>(static_cast<std::uint8_t>(node->type));
+      writer.write<std::uint8_t>(static_cast<std::uint8_t>(node->gen_node_label));
+      writer.write<std::uint8_t>(node->frozen);
+    }
+
+    writer.write<std::uint32_t>(static_cast<std::uint32_t>(genome.genes.size()));
+    for(const auto* gene : genome.genes) {
+      const auto* link = gene->lnk;
+      writer.write<std::uint32_t>(traitIndex(genome, link->linktrait));
+      writer.write<std::uint32_t>(nodeIndices.at(link->in_node));
+      writer.write<std::uint32_t>(nodeIndices.at(link->out_node));
+      writer.write<double>(link->weight);
+      writer.write<double>(gene->innovation_num);
+      writer.write<double>(gene->mutation_num);
+      writer.write<std::uint8_t>(link->is_recurrent);
+      writer.write<std::uint8_t>(link->time_delay);
+      writer.write<std::uint8_t>(gene->enable);
+      writer.write<std::uint8_t>(gene->frozen);
+    }
+  }
+
+  Genome* Checkpoint::readGenome(Reader& reader)
+  {
+    auto id = reader.read<std::int32_t>();
+
+    std::vector<Trait*> traits;
+    std::vector<NNode*> nodes;
+    std::vector<Gene*> genes;
+    auto cleanUp = [&]() {
+      for(auto* gene : genes) delete gene;
+      for(auto* node : nodes) delete node;
+      for(auto* trait : traits) delete trait;
+      return nullptr;
+    };
+
+    auto traitCount = reader.readCount(sizeof(std::int32_t) + sizeof(double) * num_trait_params);
+    traits.reserve(traitCount);
+    for(std::uint32_t i = 0; i < traitCount; ++i) {
+      auto* trait = new Trait();
+      trait->trait_id = reader.read<std::int32_t>();
+      reader.read(trait->params, sizeof(trait->params));
+      traits.push_back(trait);
+    }
+
+    auto findTrait = [&](std::uint32_t index) -> Trait* {
+      return index > 0 && index <= traits.size() ? traits[index - 1] : nullptr;
+    };
+
+    auto nodeCount = reader.readCount(15);
+    nodes.reserve(nodeCount);
+    for(std::uint32_t i = 0; i < nodeCount; ++i) {
+      auto nodeId = reader.read<std::int32_t>();
+      auto* trait = findTrait(reader.read<std::uint32_t>());
+      auto traitId = reader.read<std::int32_t>();
+      auto type = static_cast<nodetype>(reader.read<std::uint8_t>());
+      auto label = static_cast<nodeplace>(reader.read<std::uint8_t>());
+
+      auto* node = new NNode(type, nodeId, label);
+      node->nodetrait = trait;
+      node->trait_id = traitId;
+      node->frozen = reader.read<std::uint8_t>() != 0;
+      nodes.push_back(node);
+    }
+
+    auto geneCount = reader.readCount(40);
+    genes.reserve(geneCount);
+    for(std::uint32_t i = 0; i < geneCount; ++i) {
+      auto* trait = findTrait(reader.read<std::uint32_t>());
+      auto in = reader.read<std::uint32_t>();
+      auto out = reader.read<std::uint32_t>();
+      auto weight = reader.read<double>();
+      auto innovation = reader.read<double>();
+      auto mutation = reader.read<double>();
+      auto recurrent = reader.read<std::uint8_t>() != 0;
+      auto timeDelay = reader.read<std::uint8_t>() != 0;
+      auto enable = reader.read<std::uint8_t>() != 0;
+      auto frozen = reader.read<std::uint8_t>() != 0;
+      if(!reader.good() || in >= nodes.size() || out >= nodes.size()) {
+        return cleanUp();
+      }
+
+      auto* gene = new Gene(trait, weight, nodes[in], nodes[out], recurrent, innovation, mutation);
+      gene->lnk->time_delay = timeDelay;
+      gene->enable = enable;
+      gene->frozen = frozen;
+      genes.push_back(gene);
+    }
+
+    if(!reader.good()) {
+      return cleanUp();
+    }
+    return new Genome(id, traits, nodes, genes);
+  }
+
+  constexpr char Checkpoint::MAGIC[4];
+
+  std::vector<char> Checkpoint::serialize(const Population& population, std::uint64_t generation)
+  {
+    NEAT_PROFILE_SCOPE("checkpoint_serialize");
+    std::vector<char> buffer;
+    Writer writer(buffer);
+
+    writer.write(MAGIC, sizeof(MAGIC));
+    writer.write<std::uint32_t>(VERSION);
+    writer.write<std::uint64_t>(generation);
+
+    writer.write<std::int32_t>(population.cur_node_id);
+    writer.write<double>(population.cur_innov_num);
+    writer.write<std::int32_t>(population.last_species);
+    writer.write<double>(population.mean_fitness);
+    writer.write<double>(population.variance);
+    writer.write<double>(population.standard_deviation);
+    writer.write<std::int32_t>(population.winnergen);
+    writer.write<double>(population.highest_fitness);
+    writer.write<std::int32_t>(population.highest_last_changed);
+
+    auto rng = population.rng.getState();
+    writer.write(rng.words, sizeof(rng.words));
+    writer.write<std::uint64_t>(rng.seed);
+    writer.write<std::uint64_t>(rng.stream);
+    writer.write<double>(rng.gauss);
+    writer.write<std::uint8_t>(rng.hasGauss);
+
+    const auto& innovations = population.innovations.get_innovations();
+    writer.write<std::uint32_t>(static_cast<std::uint32_t>(innovations.size()));
+    for(const auto* innovation : innovations) {
+      writer.write<std::uint8_t>(static_cast<std::uint8_t>(innovation->innovation_type));
+      writer.write<std::int32_t>(innovation->node_in_id);
+      writer.write<std::int32_t>(innovation->node_out_id);
+      writer.write<double>(innovation->innovation_num1);
+      writer.write<double>(innovation->innovation_num2);
+      writer.write<double>(innovation->new_weight);
+      writer.write<std::int32_t>(innovation->new_traitnum);
+      writer.write<std::int32_t>(innovation->newnode_id);
+      writer.write<double>(innovation->old_innov_num);
+      writer.write<std::uint8_t>(innovation->recur_flag);
+    }
+
+    std::unordered_map<const Organism*, std::uint32_t> organismIndices;
+    writer.write<std::uint32_t>(static_cast<std::uint32_t>(population.organisms.size()));
+    for(std::size_t i = 0; i < population.organisms.size(); ++i) {
+      const auto* organism = population.organisms[i];
+      organismIndices[organism] = static_cast<std::uint32_t>(i);
+      writer.write<double>(organism->fitness);
+      writer.write<double>(organism->orig_fitness);
+      writer.write<double>(organism->error);
+      writer.write<double>(organism->expected_offspring);
+      writer.write<std::int32_t>(organism->generation);
+      writer.write<std::int32_t>(organism->time_alive);
+      writer.write<std::uint8_t>(organism->winner);
+      writer.write<std::uint8_t>(organism->mut_struct_baby);
+      writer.write<std::uint8_t>(organism->mate_baby);
+
+      // only the string is kept, whatever follows its end is zeroed so
+      // that the same population always gives the same bytes
+      char metadata[sizeof(organism->metadata)] = {};
+      std::memcpy(metadata, organism->metadata, strnlen(organism->metadata, sizeof(metadata) - 1));
+      writer.write(metadata, sizeof(metadata));
+
+      writeGenome(writer, *organism->gnome);
+    }
+
+    writer.write<std::uint32_t>(static_cast<std::uint32_t>(population.species.size()));
+    for(const auto* species : population.species) {
+      writer.write<std::int32_t>(species->id);
+      writer.write<std::int32_t>(species->age);
+      writer.write<double>(species->ave_fitness);
+      writer.write<double>(species->max_fitness);
+      writer.write<double>(species->max_fitness_ever);
+      writer.write<std::int32_t>(species->expected_offspring);
+      writer.write<std::int32_t>(species->age_of_last_improvement);
+      writer.write<double>(species->average_est);
+      writer.write<std::uint8_t>(species->novel);
+      writer.write<std::uint8_t>(species->obliterate);
+
+      writer.write<std::uint32_t>(static_cast<std::uint32_t>(species->organisms.size()));
+      for(const auto* organism : species->organisms) {
+        writer.write<std::uint32_t>(organismIndices.at(organism));
+      }
+    }
+
+    return buffer;
+  }
+
+  bool Checkpoint::save(const Population& population, std::uint64_t generation, const std::string& filename)
+  {
+    auto buffer = serialize(population, generation);
+
+    std::ofstream out(filename, std::ios::binary | std::ios::trunc);
+    out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    return static_cast<bool>(out);
+  }
+
+  std::unique_ptr<Population> Checkpoint::deserialize(const char* data, std::size_t size, std::uint64_t& generation)
+  {
+    Reader reader(data, size);
+
+    char magic[sizeof(MAGIC)];
+    reader.read(magic, sizeof(magic));
+    if(!reader.good() || std::memcmp(magic, MAGIC, sizeof(MAGIC)) != 0 || reader.read<std::uint32_t>() != VERSION) {
+      return nullptr;
+    }
+
+    std::unique_ptr<Population> population(new Population());
+    auto readGeneration = reader.read<std::uint64_t>();
+
+    population->cur_node_id = reader.read<std::int32_t>();
+    population->cur_innov_num = reader.read<double>();
+    population->last_species = reader.read<std::int32_t>();
+    population->mean_fitness = reader.read<double>();
+    population->variance = reader.read<double>();
+    population->standard_deviation = reader.read<double>();
+    population->winnergen = reader.read<std::int32_t>();
+    population->highest_fitness = reader.read<double>();
+    population->highest_last_changed = reader.read<std::int32_t>();
+
+    RNG::State rng;
+    reader.read(rng.words, sizeof(rng.words));
+    rng.seed = reader.read<std::uint64_t>();
+    rng.stream = reader.read<std::uint64_t>();
+    rng.gauss = reader.read<double>();
+    rng.hasGauss = reader.read<std::uint8_t>() != 0;
+    population->rng.setState(rng);
+
+    auto innovationCount = reader.readCount(54);
+    for(std::uint32_t i = 0; i < innovationCount; ++i) {
+      auto type = reader.read<std::uint8_t>();
+      auto in = reader.read<std::int32_t>();
+      auto out = reader.read<std::int32_t>();
+      auto* innovation = type == NEWNODE ? new Innovation(in, out, 0.0, 0.0, 0, 0.0)
+                                         : new Innovation(in, out, 0.0, 0.0, 0);
+      innovation->innovation_num1 = reader.read<double>();
+      innovation->innovation_num2 = reader.read<double>();
+      innovation->new_weight = reader.read<double>();
+      innovation->new_traitnum = reader.read<std::int32_t>();
+      innovation->newnode_id = reader.read<std::int32_t>();
+      innovation->old_innov_num = reader.read<double>();
+      innovation->recur_flag = reader.read<std::uint8_t>() != 0;
+      population->innovations.add(innovation);
+    }
+
+    auto organismCount = reader.readCount(177);
+    population->organisms.reserve(organismCount);
+    for(std::uint32_t i = 0; i < organismCount; ++i) {
+      auto fitness = reader.read<double>();
+      auto origFitness = reader.read<double>();
+      auto error = reader.read<double>();
+      auto expectedOffspring = reader.read<double>();
+      auto organismGeneration = reader.read<std::int32_t>();
+      auto timeAlive = reader.read<std::int32_t>();
+      auto winner = reader.read<std::uint8_t>() != 0;
+      auto mutStructBaby = reader.read<std::uint8_t>() != 0;
+      auto mateBaby = reader.read<std::uint8_t>() != 0;
+      char metadata[sizeof(Organism::metadata)];
+      reader.read(metadata, sizeof(metadata));
+      metadata[sizeof(metadata) - 1] = '\0';
+
+      auto* genome = reader.good() ? readGenome(reader) : nullptr;
+      if(!genome) {
+        return nullptr;
+      }
+
+      auto* organism = new Organism(fitness, genome, organismGeneration, metadata);
+      organism->orig_fitness = origFitness;
+      organism->error = error;
+      organism->expected_offspring = expectedOffspring;
+      organism->time_alive = timeAlive;
+      organism->winner = winner;
+      organism->mut_struct_baby = mutStructBaby;
+      organism->mate_baby = mateBaby;
+      population->organisms.push_back(organism);
+    }
+
+    auto speciesCount = reader.readCount(50);
+    population->species.reserve(speciesCount);
+    for(std::uint32_t i = 0; i < speciesCount; ++i) {
+      auto* species = new Species(reader.read<std::int32_t>());
+      population->species.push_back(species);
+
+      species->age = reader.read<std::int32_t>();
+      species->ave_fitness = reader.read<double>();
+      species->max_fitness = reader.read<double>();
+      species->max_fitness_ever = reader.read<double>();
+      species->expected_offspring = reader.read<std::int32_t>();
+      species->age_of_last_improvement = reader.read<std::int32_t>();
+      species->average_est = reader.read<double>();
+      species->novel = reader.read<std::uint8_t>() != 0;
+      species->obliterate = reader.read<std::uint8_t>() != 0;
+
+      auto memberCount = reader.readCount(sizeof(std::uint32_t));
+      species->organisms.reserve(memberCount);
+      for(std::uint32_t m = 0; m < memberCount; ++m) {
+        auto index = reader.read<std::uint32_t>();
+        if(!reader.good() || index >= population->organisms.size()) {
+          return nullptr;
+        }
+
+        auto* organism = population->organisms[index];
+        species->organisms.push_back(organism);
+        organism->species = species;
+      }
+    }
+
+    if(!reader.good()) {
+      return nullptr;
+    }
+
+    generation = readGeneration;
+    return population;
+  }
+
+  std::unique_ptr<Population> Checkpoint::load(const std::string& filename, std::uint64_t& generation)
+  {
+    std::ifstream in(filename, std::ios::binary | std::ios::ate);
+    if(!in) {
+      return nullptr;
+    }
+
+    auto size = static_cast<std::size_t>(in.tellg());
+    std::vector<char> buffer(size);
+    in.seekg(0);
+    if(!in.read(buffer.data(), static_cast<std::streamsize>(size))) {
+      return nullptr;
+    }
+
+    return deserialize(buffer.data(), buffer.size(), generation);
+  }
+}
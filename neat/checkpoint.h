@@ -0,0 +1,46 @@
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace NEAT
+{
+  class Genome;
+  class Population;
+
+  // Binary snapshot of a Population: every genome with its traits, nodes
+  // and genes, the organisms and their species, the innovations of the
+  // current generation, the RNG state and the generation counter. Values
+  // are stored in native byte order and at full precision, so a loaded
+  // population prints exactly the same text file as the saved one
+  //
+  // Layout: "NEAT" VERSION generation population-counters rng-state
+  //         innovations organisms(genomes) species(organism indices)
+  class Checkpoint
+  {
+  public:
+    static constexpr char           MAGIC[4] = { 'N', 'E', 'A', 'T' };
+    static constexpr std::uint32_t  VERSION = 1;
+
+    static std::vector<char> serialize(const Population& population, std::uint64_t generation);
+    static bool save(const Population& population, std::uint64_t generation, const std::string& filename);
+
+    // The file is read with a single read and parsed from memory. Returns
+    // null when the file is missing, truncated or of another version
+    static std::unique_ptr<Population> deserialize(const char* data, std::size_t size, std::uint64_t& generation);
+    static std::unique_ptr<Population> load(const std::string& filename, std::uint64_t& generation);
+
+  private:
+    class Reader;
+    class Writer;
+
+    static void writeGenome(Writer& writer, const Genome& genome);
+    static Genome* readGenome(Reader& reader);
+  };
+}
+
+#endif // CHECKPOINT_H
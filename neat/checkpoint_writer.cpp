@@ -0,0 +1,119 @@
+#include "checkpoint_writer.h"
+
+#include <filesystem>
+#include <fstream>
+#include "profiler.h"
+
+namespace NEAT
+{
+  CheckpointWriter::CheckpointWriter(const std::string& filename, std::size_t keep) :
+    m_filename(filename),
+    m_keep(keep > 0 ? keep : 1),
+    m_hasPending(false),
+    m_busy(false),
+    m_failed(false),
+    m_stop(false),
+    m_thread(&CheckpointWriter::writerLoop, this)
+  {
+  }
+
+  CheckpointWriter::~CheckpointWriter()
+  {
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_stop = true;
+    }
+    m_wake.notify_one();
+
+    // the loop writes what is still pending before it quits
+    m_thread.join();
+  }
+
+  void CheckpointWriter::submit(std::vector<char> buffer)
+  {
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_pending = std::move(buffer);
+      m_hasPending = true;
+    }
+    m_wake.notify_one();
+  }
+
+  bool CheckpointWriter::flush()
+  {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_idle.wait(lock, [this]() { return !m_hasPending && !m_busy; });
+
+    auto succeeded = !m_failed;
+    m_failed = false;
+    return succeeded;
+  }
+
+  bool CheckpointWriter::pollFailure()
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto failed = m_failed;
+    m_failed = false;
+    return failed;
+  }
+
+  void CheckpointWriter::writerLoop()
+  {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while(true) {
+      m_wake.wait(lock, [this]() { return m_hasPending || m_stop; });
+      if(!m_hasPending) {
+        return;
+      }
+
+      auto buffer = std::move(m_pending);
+      m_hasPending = false;
+      m_busy = true;
+
+      lock.unlock();
+      auto succeeded = write(buffer);
+      lock.lock();
+
+      m_failed = m_failed || !succeeded;
+      m_busy = false;
+      if(!m_hasPending) {
+        m_idle.notify_all();
+      }
+    }
+  }
+
+  bool CheckpointWriter::write(const std::vector<char>& buffer) const
+  {
+    NEAT_PROFILE_SCOPE("checkpoint_write");
+    namespace fs = std::filesystem;
+
+    auto temporary = m_filename + ".tmp";
+    {
+      std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+      out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+      out.close();
+      if(!out) {
+        return false;
+      }
+    }
+
+    // filename.(keep - 2) -> filename.(keep - 1), ... and filename is
+    // copied to filename.1, so it stays in place until the rename below
+    // replaces it in one step
+    std::error_code error;
+    for(auto i = m_keep - 1; i > 0; --i) {
+      auto to = m_filename + "." + std::to_string(i);
+      if(i > 1) {
+        auto from = m_filename + "." + std::to_string(i - 1);
+        if(fs::exists(from, error)) {
+          fs::rename(from, to, error);
+        }
+      } else if(fs::exists(m_filename, error)) {
+        fs::copy_file(m_filename, to, fs::copy_options::overwrite_existing, error);
+      }
+    }
+
+    fs::rename(temporary, m_filename, error);
+    return !error;
+  }
+}
@@ -0,0 +1,60 @@
+#ifndef CHECKPOINT_WRITER_H
+#define CHECKPOINT_WRITER_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace NEAT
+{
+  // Writes serialized checkpoints to disk on a background thread, so that
+  // training only pays for the in-memory copy. Each write goes to a
+  // temporary file that is renamed over the checkpoint once complete, after
+  // the older checkpoints were shifted to filename.1, filename.2, ...
+  // A crash mid-write therefore always leaves a whole checkpoint behind
+  class CheckpointWriter
+  {
+  public:
+    // keeps the checkpoint and up to keep - 1 older ones
+    explicit CheckpointWriter(const std::string& filename, std::size_t keep = 3);
+    ~CheckpointWriter();
+
+    CheckpointWriter(const CheckpointWriter&) = delete;
+    CheckpointWriter& operator=(const CheckpointWriter&) = delete;
+
+    // Queues the buffer for writing. When the thread is still busy with
+    // an earlier checkpoint, a queued one that wasn't started is replaced
+    void submit(std::vector<char> buffer);
+
+    // Waits until every submitted checkpoint is on disk. Returns false
+    // when one of the writes failed since the last flush
+    bool flush();
+
+    // Same without waiting, true when one of the writes that are done
+    // failed since the last flush or poll
+    bool pollFailure();
+
+  private:
+    void writerLoop();
+    bool write(const std::vector<char>& buffer) const;
+
+    std::string               m_filename;
+    std::size_t               m_keep;
+
+    std::mutex                m_mutex;
+    std::condition_variable   m_wake;
+    std::condition_variable   m_idle;
+    std::vector<char>         m_pending;
+    bool                      m_hasPending;
+    bool                      m_busy;
+    bool                      m_failed;
+    bool                      m_stop;
+
+    std::thread               m_thread;
+  };
+}
+
+#endif // CHECKPOINT_WRITER_H
@@ -0,0 +1,185 @@
+#include "compiled_network.h"
+
+#include <algorithm>
+#include <unordered_map>
+#include "genome.h"
+#include "neat.h"
+
+namespace NEAT
+{
+  CompiledNetwork::CompiledNetwork(const Genome& genome)
+  {
+    const auto nodeCount = genome.nodes.size();
+
+    std::unordered_map<const NNode*, std::uint32_t> indices;
+    indices.reserve(nodeCount);
+
+    std::vector<std::uint32_t> neuronIndex(nodeCount, 0);
+    for(std::size_t i = 0; i < nodeCount; ++i) {
+      const auto* node = genome.nodes[i];
+      indices.emplace(node, static_cast<std::uint32_t>(i));
+
+      if(node->type == SENSOR) {
+        // same filter as genesis and Network::load_sensors
+        if(node->gen_node_label == INPUT || node->gen_node_label == BIAS) {
+          m_sensors.push_back(static_cast<std::uint32_t>(i));
+        }
+      } else {
+        neuronIndex[i] = static_cast<std::uint32_t>(m_neurons.size());
+        m_neurons.push_back(static_cast<std::uint32_t>(i));
+      }
+
+      if(node->gen_node_label == OUTPUT) {
+        m_outputs.push_back(static_cast<std::uint32_t>(i));
+      }
+    }
+
+    // bucket the enabled genes by their out node, keeping the gene order so
+    // the sums are accumulated in the same order as the linked Network
+    m_connectionOffsets.assign(m_neurons.size() + 1, 0);
+    for(const auto* gene : genome.genes) {
+      if(gene->enable) {
+        auto out = indices[gene->lnk->out_node];
+        if(genome.nodes[out]->type != SENSOR) {
+          ++m_connectionOffsets[neuronIndex[out] + 1];
+        }
+      }
+    }
+    for(std::size_t i = 1; i < m_connectionOffsets.size(); ++i) {
+      m_connectionOffsets[i] += m_connectionOffsets[i - 1];
+    }
+
+    m_connections.resize(m_connectionOffsets.back());
+    auto next = m_connectionOffsets;
+    for(const auto* gene : genome.genes) {
+      if(gene->enable) {
+        auto out = indices[gene->lnk->out_node];
+        if(genome.nodes[out]->type != SENSOR) {
+          m_connections[next[neuronIndex[out]]++] = Connection{ indices[gene->lnk->in_node], gene->lnk->weight };
+        }
+      }
+    }
+
+    m_activation.resize(nodeCount);
+    m_activesum.resize(nodeCount);
+    m_activated.resize(nodeCount);
+    m_activeFlag.resize(nodeCount);
+    flush();
+
+    m_topologyHash = computeTopologyHash();
+  }
+
+  void CompiledNetwork::loadSensors(const double* values)
+  {
+    for(auto sensor : m_sensors) {
+      m_activation[sensor] = *values++;
+      m_activated[sensor] = 1;
+    }
+  }
+
+  bool CompiledNetwork::activate()
+  {
+    // an input counts as active if it is a sensor or a neuron whose flag
+    // is set, flush() sets the flag of the sensors permanently
+    auto onetime = false;
+    auto abortcount = 0;
+    while(outputsOff() || !onetime) {
+      if(++abortcount == 20) {
+        return false;
+      }
+
+      const auto neuronCount = m_neurons.size();
+      for(std::size_t i = 0; i < neuronCount; ++i) {
+        auto sum = 0.0;
+        unsigned char active = 0;
+        for(auto c = m_connectionOffsets[i], end = m_connectionOffsets[i + 1]; c < end; ++c) {
+          const auto& connection = m_connections[c];
+          sum += connection.weight * m_activation[connection.source];
+          active |= m_activeFlag[connection.source];
+        }
+
+        auto node = m_neurons[i];
+        m_activesum[node] = sum;
+        m_activeFlag[node] = active;
+      }
+
+      for(std::size_t i = 0; i < neuronCount; ++i) {
+        auto node = m_neurons[i];
+        if(m_activeFlag[node]) {
+          m_activation[node] = fsigmoid(m_activesum[node], 4.924273, 2.4621365);
+          m_activated[node] = 1;
+        }
+      }
+
+      onetime = true;
+    }
+
+    return true;
+  }
+
+  void CompiledNetwork::flush()
+  {
+    std::fill(m_activation.begin(), m_activation.end(), 0.0);
+    std::fill(m_activesum.begin(), m_activesum.end(), 0.0);
+    std::fill(m_activated.begin(), m_activated.end(), 0);
+    // every node that is not a neuron is a sensor, and sensors always count as active
+    std::fill(m_activeFlag.begin(), m_activeFlag.end(), 1);
+    for(auto neuron : m_neurons) {
+      m_activeFlag[neuron] = 0;
+    }
+  }
+
+  bool CompiledNetwork::hasSameTopology(const CompiledNetwork& other) const
+  {
+    if(m_topologyHash != other.m_topologyHash ||
+       m_activation.size() != other.m_activation.size() ||
+       m_sensors != other.m_sensors ||
+       m_outputs != other.m_outputs ||
+       m_neurons != other.m_neurons ||
+       m_connectionOffsets != other.m_connectionOffsets) {
+      return false;
+    }
+
+    for(std::size_t i = 0; i < m_connections.size(); ++i) {
+      if(m_connections[i].source != other.m_connections[i].source) {
+        return false;
+      }
+    }
+
+    return true;
+  }
+
+  bool CompiledNetwork::outputsOff() const
+  {
+    for(auto output : m_outputs) {
+      if(!m_activated[output]) {
+        return true;
+      }
+    }
+
+    return false;
+  }
+
+  std::uint64_t CompiledNetwork::computeTopologyHash() const
+  {
+    // FNV-1a over everything but the weights
+    std::uint64_t hash = 14695981039346656037ULL;
+    auto combine = [&hash](std::uint64_t value) {
+      hash ^= value;
+      hash *= 1099511628211ULL;
+    };
+
+    combine(m_activation.size());
+    for(const auto* list : { &m_sensors, &m_outputs, &m_neurons, &m_connectionOffsets }) {
+      combine(list->size());
+      for(auto value : *list) {
+        combine(value);
+      }
+    }
+    for(const auto& connection : m_connections) {
+      combine(connection.source);
+    }
+
+    return hash;
+  }
+}
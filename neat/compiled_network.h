@@ -0,0 +1,77 @@
+#ifndef COMPILED_NETWORK_H
+#define COMPILED_NETWORK_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace NEAT
+{
+  class Genome;
+
+  // Flat phenotype of a Genome. The incoming connections of every neuron
+  // are stored contiguously as (source index, weight) pairs and the node
+  // state lives in flat arrays indexed by node, so an activation pass is a
+  // linear walk with no pointer chasing.
+  //
+  // activate() reproduces Network::activate exactly: every pass first sums
+  // the incoming activations of all neurons, then squashes them, and passes
+  // are repeated until every output has fired. Time delayed links, overrides
+  // and adaptation are not supported, genesis never creates them
+  class CompiledNetwork
+  {
+  public:
+    struct Connection
+    {
+      std::uint32_t source;
+      double        weight;
+    };
+
+    // Prefer Genome::compile
+    explicit CompiledNetwork(const Genome& genome);
+
+    // Loads one value per sensor, in the same order as Network::load_sensors
+    void loadSensors(const double* values);
+
+    // Returns false if the outputs could not be reached within 20 passes
+    bool activate();
+
+    // Resets the network to the state it had when it was compiled
+    void flush();
+
+    std::size_t getSensorCount() const { return m_sensors.size(); }
+    std::size_t getOutputCount() const { return m_outputs.size(); }
+    double getOutput(std::size_t index) const { return m_activation[m_outputs[index]]; }
+
+    std::size_t getNodeCount() const { return m_activation.size(); }
+    std::size_t getConnectionCount() const { return m_connections.size(); }
+
+    // Networks with the same topology only differ in their weights
+    std::uint64_t getTopologyHash() const { return m_topologyHash; }
+    bool hasSameTopology(const CompiledNetwork& other) const;
+
+  private:
+    friend class NetworkBatch;
+
+    bool outputsOff() const;
+    std::uint64_t computeTopologyHash() const;
+
+    std::vector<std::uint32_t>  m_sensors;
+    std::vector<std::uint32_t>  m_outputs;
+
+    // neurons in node order, the incoming connections of m_neurons[i]
+    // are m_connections[m_connectionOffsets[i], m_connectionOffsets[i + 1])
+    std::vector<std::uint32_t>  m_neurons;
+    std::vector<std::uint32_t>  m_connectionOffsets;
+    std::vector<Connection>     m_connections;
+
+    std::vector<double>         m_activation;
+    std::vector<double>         m_activesum;
+    std::vector<unsigned char>  m_activated;
+    std::vector<unsigned char>  m_activeFlag;
+
+    std::uint64_t               m_topologyHash;
+  };
+}
+
+#endif // COMPILED_NETWORK_H
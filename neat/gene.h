@@ -20,10 +20,11 @@
 #include "trait.h"
 #include "link.h"
 #include "network.h"
+#include "pool.h"
 
 namespace NEAT {
 
-	class Gene {
+	class Gene : public PoolAllocated<Gene> {
 	public:
 
 		Link *lnk;
@@ -15,11 +15,129 @@
 */
 #include "genome.h"
 
+#include <algorithm>
 #include <iostream>
 #include <cmath>
+#include <cstdint>
 #include <sstream>
+#include <unordered_map>
+#include <unordered_set>
 using namespace NEAT;
 
+//Packs the node ids at both ends of a link into one key
+static inline std::uint64_t link_key(int in_node_id,int out_node_id) {
+	return (((std::uint64_t) (std::uint32_t) in_node_id)<<32)|((std::uint32_t) out_node_id);
+}
+
+//The connections the phenotype of a genome would have, by node index:
+//the links into node n are in_node[first[n]] to in_node[first[n+1]-1],
+//from the enabled genes in gene order like the incoming lists genesis
+//builds. Enough to check for recurrency without building a Network
+struct genome_graph {
+	std::vector<int> first;
+	std::vector<int> in_node;
+	std::vector<char> recurrent;
+
+	explicit genome_graph(const std::vector<NNode*> &nodes,const std::vector<Gene*> &genes) {
+		std::unordered_map<const NNode*,int> index;
+		for(int i=0;i<(int) nodes.size();i++)
+			index[nodes[i]]=i;
+
+		first.assign(nodes.size()+1,0);
+		for(const Gene *gene : genes)
+			if (gene->enable)
+				first[index[gene->lnk->out_node]+1]++;
+		for(std::size_t i=1;i<first.size();i++)
+			first[i]+=first[i-1];
+
+		std::vector<int> next(first.begin(),first.end()-1);
+		in_node.resize(first.back());
+		recurrent.resize(first.back());
+		for(const Gene *gene : genes)
+			if (gene->enable) {
+				int slot=next[index[gene->lnk->out_node]]++;
+				in_node[slot]=index[gene->lnk->in_node];
+				recurrent[slot]=gene->lnk->is_recurrent;
+			}
+	}
+
+	//Same walk as Network::is_recur, so count and the result match it
+	bool is_recur(int potin_node,int potout_node,int &count,int thresh) const {
+		++count;  //Count the node as visited
+
+		if (count>thresh)
+			return false;  //Short out the whole thing- loop detected
+
+		if (potin_node==potout_node) return true;
+
+		//Check back on all links, but skip links that are already recurrent
+		for(int link=first[potin_node];link<first[potin_node+1];link++)
+			if (!recurrent[link])
+				if (is_recur(in_node[link],potout_node,count,thresh)) return true;
+		return false;
+	}
+};
+
+//What a baby Genome has inherited so far while its parents are mated:
+//its NNodes by id and the links of its Genes, so a chosen gene is checked
+//for a duplicate link and its nodes for existence in constant time rather
+//than by scanning everything inherited before. The nodes are appended as
+//they are inherited and sorted by id once, when the baby is complete
+struct Genome::crossover_index {
+	std::vector<NNode*> &newnodes;
+	std::vector<Trait*> &newtraits;
+	int first_trait_id;  //To normalize trait numbers like the mating methods
+	std::vector<NNode*> node_map;  //The baby's NNodes by node_id, ids are handed out in sequence
+	std::unordered_set<std::uint64_t> links[2];  //Non recurrent and recurrent links
+
+	crossover_index(std::vector<NNode*> &nodes,std::vector<Trait*> &traits,int first_id,Genome *mom,Genome *dad) :
+		newnodes(nodes),newtraits(traits),first_trait_id(first_id) {
+		int max_id=0;
+		for(const Genome *parent : {mom,dad})
+			for(const NNode *node : parent->nodes)
+				max_id=std::max(max_id,node->node_id);
+		node_map.assign(max_id+1,0);
+		links[0].reserve(mom->genes.size()+dad->genes.size());
+	}
+
+	//The gene represents the same link as an inherited gene, or reverses
+	//an inherited one while neither of them is recurrent
+	bool conflicts(const Gene *gene) const {
+		int in_id=gene->lnk->in_node->node_id;
+		int out_id=gene->lnk->out_node->node_id;
+		bool recurrent=gene->lnk->is_recurrent;
+		return links[recurrent].count(link_key(in_id,out_id))||
+			((!recurrent)&&links[0].count(link_key(out_id,in_id)));
+	}
+
+	void add_link(const Gene *gene) {
+		links[gene->lnk->is_recurrent].insert(link_key(gene->lnk->in_node->node_id,gene->lnk->out_node->node_id));
+	}
+
+	//The baby's copy of a parent NNode, created the first time it is needed
+	NNode *get_node(NNode *node) {
+		if (node->node_id>=(int) node_map.size())
+			node_map.resize(node->node_id+1,0);
+
+		NNode *&new_node=node_map[node->node_id];
+		if (!new_node) {
+			int nodetraitnum;
+			if (!(node->nodetrait)) nodetraitnum=0;
+			else
+				nodetraitnum=((node->nodetrait)->trait_id)-first_trait_id;
+
+			new_node=new NNode(node,newtraits[nodetraitnum]);
+			newnodes.push_back(new_node);
+		}
+		return new_node;
+	}
+
+	//Same order node_insert keeps
+	void sort_nodes() {
+		std::sort(newnodes.begin(),newnodes.end(),[](const NNode *a,const NNode *b) { return a->node_id<b->node_id; });
+	}
+};
+
 Genome::Genome(int id, std::vector<Trait*> t, std::vector<NNode*> n, std::vector<Gene*> g) {
 	genome_id=id;
 	traits=t;
@@ -221,7 +339,7 @@ Genome::Genome(int id, std::ifstream &iFile) {
 }
 
 
-Genome::Genome(int new_id,int i, int o, int n,int nmax, bool r, double linkprob) {
+Genome::Genome(int new_id,int i, int o, int n,int nmax, bool r, double linkprob, RNG &rng) {
 	int totalnodes;
 	bool *cm; //The connection matrix which will be randomized
 	bool *cmp; //Connection matrix pointer
@@ -265,7 +383,7 @@ Genome::Genome(int new_id,int i, int o, int n,int nmax, bool r, double linkprob)
 	//Step through the connection matrix, randomly assigning bits
 	cmp=cm;
 	for(count=0;count<matrixdim;count++) {
-		if (randfloat()<linkprob)
+		if (rng.randfloat()<linkprob)
 			*cmp=true;
 		else *cmp=false;
 		cmp++;
@@ -337,7 +455,7 @@ Genome::Genome(int new_id,int i, int o, int n,int nmax, bool r, double linkprob)
 						out_node=(*node_iter);
 
 						//Create the gene
-						new_weight=randposneg()*randfloat();
+						new_weight=rng.randposneg()*rng.randfloat();
 						newgene=new Gene(newtrait,new_weight, in_node, out_node,false,count,new_weight);
 
 						//Add the gene to the genome
@@ -361,7 +479,7 @@ Genome::Genome(int new_id,int i, int o, int n,int nmax, bool r, double linkprob)
 						out_node=(*node_iter);
 
 						//Create the gene
-						new_weight=randposneg()*randfloat();
+						new_weight=rng.randposneg()*rng.randfloat();
 						newgene=new Gene(newtrait,new_weight, in_node, out_node,true,count,new_weight);
 
 						//Add the gene to the genome
@@ -724,6 +842,10 @@ Network *Genome::genesis(int id) {
 
 }
 
+CompiledNetwork Genome::compile() const {
+	return CompiledNetwork(*this);
+}
+
 bool Genome::verify() {
 	std::vector<NNode*>::iterator curnode;
 	std::vector<Gene*>::iterator curgene;
@@ -1000,22 +1122,22 @@ Genome *Genome::duplicate(int new_id) {
 
 }
 
-void Genome::mutate_random_trait() {
+void Genome::mutate_random_trait(RNG &rng) {
 	std::vector<Trait*>::iterator thetrait; //Trait to be mutated
 	int traitnum;
 
 	//Choose a random traitnum
-	traitnum=randint(0,(traits.size())-1);
+	traitnum=rng.randint(0,(traits.size())-1);
 
 	//Retrieve the trait and mutate it
 	thetrait=traits.begin();
-	(*(thetrait[traitnum])).mutate();
+	(*(thetrait[traitnum])).mutate(rng);
 
 	//TRACK INNOVATION? (future possibility)
 
 }
 
-void Genome::mutate_link_trait(int times) {
+void Genome::mutate_link_trait(int times,RNG &rng) {
 	int traitnum;
 	int genenum;
 	std::vector<Gene*>::iterator thegene;     //Link to be mutated
@@ -1026,10 +1148,10 @@ void Genome::mutate_link_trait(int times) {
 	for(loop=1;loop<=times;loop++) {
 
 		//Choose a random traitnum
-		traitnum=randint(0,(traits.size())-1);
+		traitnum=rng.randint(0,(traits.size())-1);
 
 		//Choose a random linknum
-		genenum=randint(0,genes.size()-1);
+		genenum=rng.randint(0,genes.size()-1);
 
 		//set the link to point to the new trait
 		thegene=genes.begin();
@@ -1049,7 +1171,7 @@ void Genome::mutate_link_trait(int times) {
 	}
 }
 
-void Genome::mutate_node_trait(int times) {
+void Genome::mutate_node_trait(int times,RNG &rng) {
 	int traitnum;
 	int nodenum;
 	std::vector<NNode*>::iterator thenode;     //Link to be mutated
@@ -1061,10 +1183,10 @@ void Genome::mutate_node_trait(int times) {
 	for(loop=1;loop<=times;loop++) {
 
 		//Choose a random traitnum
-		traitnum=randint(0,(traits.size())-1);
+		traitnum=rng.randint(0,(traits.size())-1);
 
 		//Choose a random nodenum
-		nodenum=randint(0,nodes.size()-1);
+		nodenum=rng.randint(0,nodes.size()-1);
 
 		//set the link to point to the new trait
 		thenode=nodes.begin();
@@ -1091,7 +1213,7 @@ void Genome::mutate_node_trait(int times) {
 	}
 }
 
-void Genome::mutate_link_weights(double power,double rate,mutator mut_type) {
+void Genome::mutate_link_weights(double power,double rate,mutator mut_type,RNG &rng) {
 	std::vector<Gene*>::iterator curgene;
 	double num;  //counts gene placement
 	double gene_total;
@@ -1168,7 +1290,7 @@ void Genome::mutate_link_weights(double power,double rate,mutator mut_type) {
 
 	// ------------------------------------------------------ 
 
-	if (randfloat()>0.5) severe=true;
+	if (rng.randfloat()>0.5) severe=true;
 	else severe=false;
 
 	//Go through all the Genes and perturb their link's weights
@@ -1193,8 +1315,8 @@ void Genome::mutate_link_weights(double power,double rate,mutator mut_type) {
 	if (mut_type==COLDGAUSSIAN) {
 		//printf("COLDGAUSSIAN");
 		for(curgene=genes.begin();curgene!=genes.end();curgene++) {
-			if (randfloat()<0.9) {
-				randnum=randposneg()*randfloat()*power*powermod;
+			if (rng.randfloat()<0.9) {
+				randnum=rng.randposneg()*rng.randfloat()*power*powermod;
 				((*curgene)->lnk)->weight+=randnum;
 			}
 		}
@@ -1202,8 +1324,8 @@ void Genome::mutate_link_weights(double power,double rate,mutator mut_type) {
 
 	
 	for(curgene=genes.begin();curgene!=genes.end();curgene++) {
-		if (randfloat()<0.2) {
-			randnum=randposneg()*randfloat()*power*powermod;
+		if (rng.randfloat()<0.2) {
+			randnum=rng.randposneg()*rng.randfloat()*power*powermod;
 			((*curgene)->lnk)->weight+=randnum;
 
 			//Cap the weights at 20.0 (experimental)
@@ -1247,7 +1369,7 @@ void Genome::mutate_link_weights(double power,double rate,mutator mut_type) {
 			}
 			else {
 				//Half the time don't do any cold mutations
-				if (randfloat()>0.5) {
+				if (rng.randfloat()>0.5) {
 					gausspoint=1.0-rate;
 					coldgausspoint=1.0-rate-0.1;
 				}
@@ -1261,10 +1383,10 @@ void Genome::mutate_link_weights(double power,double rate,mutator mut_type) {
 			//randnum=gaussrand()*powermod;
 			//randnum=gaussrand();
 
-			randnum=randposneg()*randfloat()*power*powermod;
+			randnum=rng.randposneg()*rng.randfloat()*power*powermod;
             //std::cout << "RANDOM: " << randnum << " " << randposneg() << " " << randfloat() << " " << power << " " << powermod << std::endl;
 			if (mut_type==GAUSSIAN) {
-				randchoice=randfloat();
+				randchoice=rng.randfloat();
 				if (randchoice>gausspoint)
 					((*curgene)->lnk)->weight+=randnum;
 				else if (randchoice>coldgausspoint)
@@ -1290,7 +1412,7 @@ void Genome::mutate_link_weights(double power,double rate,mutator mut_type) {
 
 }
 
-void Genome::mutate_toggle_enable(int times) {
+void Genome::mutate_toggle_enable(int times,RNG &rng) {
 	int genenum;
 	int count;
 	std::vector<Gene*>::iterator thegene;  //Gene to toggle
@@ -1300,7 +1422,7 @@ void Genome::mutate_toggle_enable(int times) {
 	for (count=1;count<=times;count++) {
 
 		//Choose a random genenum
-		genenum=randint(0,genes.size()-1);
+		genenum=rng.randint(0,genes.size()-1);
 
 		//find the gene
 		thegene=genes.begin();
@@ -1341,7 +1463,7 @@ void Genome::mutate_gene_reenable() {
 
 }
 
-bool Genome::mutate_add_node(std::vector<Innovation*> &innovs,int &curnode_id,double &curinnov) {
+bool Genome::mutate_add_node(InnovationDatabase &innovs,int &curnode_id,double &curinnov,RNG &rng) {
 	std::vector<Gene*>::iterator thegene;  //random gene containing the original link
 	int genenum;  //The random gene number
 	NNode *in_node; //Here are the nodes connected by the gene
@@ -1350,8 +1472,7 @@ bool Genome::mutate_add_node(std::vector<Innovation*> &innovs,int &curnode_id,do
 
 	//double randmult;  //using a gaussian to find the random gene
 
-	std::vector<Innovation*>::iterator theinnov; //For finding a historical match
-	bool done=false;
+	Innovation *theinnov; //For finding a historical match
 
 	Gene *newgene1;  //The new Genes
 	Gene *newgene2;
@@ -1383,7 +1504,7 @@ bool Genome::mutate_add_node(std::vector<Innovation*> &innovs,int &curnode_id,do
 		//We bias the search towards older genes because 
 		//this encourages splitting to distribute evenly
 		while (((thegene!=genes.end())&&
-			(randfloat()<0.3))||
+			(rng.randfloat()<0.3))||
 			((thegene!=genes.end())
 			&&(((*thegene)->lnk->in_node)->gen_node_label==BIAS)))
 		{
@@ -1413,7 +1534,7 @@ bool Genome::mutate_add_node(std::vector<Innovation*> &innovs,int &curnode_id,do
 			//This old totally random selection is bad- splitting
 			//inside something recently splitted adds little power
 			//to the system (should use a gaussian if doing it this way)
-			genenum=randint(0,genes.size()-1);
+			genenum=rng.randint(0,genes.size()-1);
 
 			//find the gene
 			thegene=genes.begin();
@@ -1450,79 +1571,37 @@ bool Genome::mutate_add_node(std::vector<Innovation*> &innovs,int &curnode_id,do
 	//Innovations are used to make sure the same innovation in
 	//two separate genomes in the same generation receives
 	//the same innovation number.
-	theinnov=innovs.begin();
-
-	while(!done) {
-
-		if (theinnov==innovs.end()) {
-
-			//The innovation is totally novel
-
-			//Get the old link's trait
-			traitptr=thelink->linktrait;
-
-			//Create the new NNode
-			//By convention, it will point to the first trait
-			newnode=new NNode(NEURON,curnode_id++,HIDDEN);
-			newnode->nodetrait=(*(traits.begin()));
-
-			//Create the new Genes
-			if (thelink->is_recurrent) {
-				newgene1=new Gene(traitptr,1.0,in_node,newnode,true,curinnov,0);
-				newgene2=new Gene(traitptr,oldweight,newnode,out_node,false,curinnov+1,0);
-				curinnov+=2.0;
-			}
-			else {
-				newgene1=new Gene(traitptr,1.0,in_node,newnode,false,curinnov,0);
-				newgene2=new Gene(traitptr,oldweight,newnode,out_node,false,curinnov+1,0);
-				curinnov+=2.0;
-			}
-
-			//Add the innovations (remember what was done)
-			innovs.push_back(new Innovation(in_node->node_id,out_node->node_id,curinnov-2.0,curinnov-1.0,newnode->node_id,(*thegene)->innovation_num));      
-
-			done=true;
+	//An innovation already occured if it was:
+	//   -A new node
+	//   -Stuck between the same nodes as were chosen for this mutation
+	//   -Splitting the same gene as chosen for this mutation 
+	//   If so, this mutation is not a novel innovation in this generation
+	//   so we make it match the original, identical mutation which occured
+	//   elsewhere in the population by coincidence 
+	{
+		std::lock_guard<std::mutex> lock(innovs.mutex);
+
+		theinnov=innovs.find_node(in_node->node_id,out_node->node_id,(*thegene)->innovation_num);
+		if (theinnov==0) {
+			//The innovation is totally novel, remember what was done
+			theinnov=new Innovation(in_node->node_id,out_node->node_id,curinnov,curinnov+1.0,curnode_id++,(*thegene)->innovation_num);
+			curinnov+=2.0;
+			innovs.add(theinnov);
 		}
+	}
 
-		// We check to see if an innovation already occured that was:
-		//   -A new node
-		//   -Stuck between the same nodes as were chosen for this mutation
-		//   -Splitting the same gene as chosen for this mutation 
-		//   If so, we know this mutation is not a novel innovation
-		//   in this generation
-		//   so we make it match the original, identical mutation which occured
-		//   elsewhere in the population by coincidence 
-		else if (((*theinnov)->innovation_type==NEWNODE)&&
-			((*theinnov)->node_in_id==(in_node->node_id))&&
-			((*theinnov)->node_out_id==(out_node->node_id))&&
-			((*theinnov)->old_innov_num==(*thegene)->innovation_num)) 
-		{
-
-			//Here, the innovation has been done before
-
-			//Get the old link's trait
-			traitptr=thelink->linktrait;
-
-			//Create the new NNode
-			newnode=new NNode(NEURON,(*theinnov)->newnode_id,HIDDEN);      
-			//By convention, it will point to the first trait
-			//Note: In future may want to change this
-			newnode->nodetrait=(*(traits.begin()));
+	//Get the old link's trait
+	traitptr=thelink->linktrait;
 
-			//Create the new Genes
-			if (thelink->is_recurrent) {
-				newgene1=new Gene(traitptr,1.0,in_node,newnode,true,(*theinnov)->innovation_num1,0);
-				newgene2=new Gene(traitptr,oldweight,newnode,out_node,false,(*theinnov)->innovation_num2,0);
-			}
-			else {
-				newgene1=new Gene(traitptr,1.0,in_node,newnode,false,(*theinnov)->innovation_num1,0);
-				newgene2=new Gene(traitptr,oldweight,newnode,out_node,false,(*theinnov)->innovation_num2,0);
-			}
+	//Create the new NNode
+	//By convention, it will point to the first trait
+	//Note: In future may want to change this
+	newnode=new NNode(NEURON,theinnov->newnode_id,HIDDEN);
+	newnode->nodetrait=(*(traits.begin()));
 
-			done=true;
-		}
-		else ++theinnov;
-	}
+	//Create the new Genes
+	newgene1=new Gene(traitptr,1.0,in_node,newnode,thelink->is_recurrent,theinnov->innovation_num1,0);
+	newgene2=new Gene(traitptr,oldweight,newnode,out_node,false,theinnov->innovation_num2,0);
 
 	//Now add the new NNode and new Genes to the Genome
 	//genes.push_back(newgene1);   //Old way to add genes- may result in genes becoming out of order
@@ -1535,7 +1614,7 @@ bool Genome::mutate_add_node(std::vector<Innovation*> &innovs,int &curnode_id,do
 
 } 
 
-bool Genome::mutate_add_link(std::vector<Innovation*> &innovs,double &curinnov,int tries) {
+bool Genome::mutate_add_link(InnovationDatabase &innovs,double &curinnov,int tries,RNG &rng) {
 
 	int nodenum1,nodenum2;  //Random node numbers
 	std::vector<NNode*>::iterator thenode1,thenode2;  //Random node iterators
@@ -1545,7 +1624,7 @@ bool Genome::mutate_add_link(std::vector<Innovation*> &innovs,double &curinnov,i
 	NNode *nodep2; //Pointers to the nodes
 	std::vector<Gene*>::iterator thegene; //Searches for existing link
 	bool found=false;  //Tells whether an open pair was found
-	std::vector<Innovation*>::iterator theinnov; //For finding a historical match
+	Innovation *theinnov; //For finding a historical match
 	int recurflag; //Indicates whether proposed link is recurrent
 	Gene *newgene;  //The new Gene
 
@@ -1554,7 +1633,6 @@ bool Genome::mutate_add_link(std::vector<Innovation*> &innovs,double &curinnov,i
 
 	double newweight;  //The new weight for the new link
 
-	bool done;
 	bool do_recur;
 	bool loop_recur;
 	int first_nonsensor;
@@ -1572,7 +1650,7 @@ bool Genome::mutate_add_link(std::vector<Innovation*> &innovs,double &curinnov,i
 
 
 	//Decide whether to make this recurrent
-	if (randfloat()<NEAT::recur_only_prob) 
+	if (rng.randfloat()<NEAT::recur_only_prob) 
 		do_recur=true;
 	else do_recur=false;
 
@@ -1585,25 +1663,35 @@ bool Genome::mutate_add_link(std::vector<Innovation*> &innovs,double &curinnov,i
 		++thenode1;
 	}
 
+	//Index the links already in the genome, so each try checks for an
+	//existing link without scanning the genes
+	std::unordered_set<std::uint64_t> links;
+	for(thegene=genes.begin();thegene!=genes.end();++thegene)
+		if ((((*thegene)->lnk)->is_recurrent)==do_recur)
+			links.insert(link_key((((*thegene)->lnk)->in_node)->node_id,(((*thegene)->lnk)->out_node)->node_id));
+
+	//The recurrency checks walk the links of the genome directly
+	genome_graph graph(nodes,genes);
+
 	//Here is the recurrent finder loop- it is done separately
 	if (do_recur) {
 
 		while(trycount<tries) {
 
 			//Some of the time try to make a recur loop
-			if (randfloat()>0.5) {
+			if (rng.randfloat()>0.5) {
 				loop_recur=true;
 			}
 			else loop_recur=false;
 
 			if (loop_recur) {
-				nodenum1=randint(first_nonsensor,nodes.size()-1);
+				nodenum1=rng.randint(first_nonsensor,nodes.size()-1);
 				nodenum2=nodenum1;
 			}
 			else {
 				//Choose random nodenums
-				nodenum1=randint(0,nodes.size()-1);
-				nodenum2=randint(first_nonsensor,nodes.size()-1);
+				nodenum1=rng.randint(0,nodes.size()-1);
+				nodenum2=rng.randint(first_nonsensor,nodes.size()-1);
 			}
 
 			//Find the first node
@@ -1619,21 +1707,14 @@ bool Genome::mutate_add_link(std::vector<Innovation*> &innovs,double &curinnov,i
 			nodep1=(*thenode1);
 			nodep2=(*thenode2);
 
-			//See if a recur link already exists  ALSO STOP AT END OF GENES!!!!
-			thegene=genes.begin();
-			while ((thegene!=genes.end()) && 
-				((nodep2->type)!=SENSOR) &&   //Don't allow SENSORS to get input
-				(!((((*thegene)->lnk)->in_node==nodep1)&&
-				(((*thegene)->lnk)->out_node==nodep2)&&
-				((*thegene)->lnk)->is_recurrent))) {
-					++thegene;
-				}
-
-				if (thegene!=genes.end())
+			//See if a recur link already exists
+			//Don't allow SENSORS to get input
+				if ((((nodep2->type)==SENSOR)&&(!genes.empty()))||
+					(links.count(link_key(nodep1->node_id,nodep2->node_id))))
 					trycount++;
 				else {
 					count=0;
-					recurflag=phenotype->is_recur(nodep1->analogue,nodep2->analogue,count,thresh);
+					recurflag=graph.is_recur(nodenum1,nodenum2,count,thresh);
 
 					//ADDED: CONSIDER connections out of outputs recurrent
 					if (((nodep1->type)==OUTPUT)||
@@ -1666,8 +1747,8 @@ bool Genome::mutate_add_link(std::vector<Innovation*> &innovs,double &curinnov,i
 			//cout<<"TRY "<<trycount<<std::endl;
 
 			//Choose random nodenums
-			nodenum1=randint(0,nodes.size()-1);
-			nodenum2=randint(first_nonsensor,nodes.size()-1);
+			nodenum1=rng.randint(0,nodes.size()-1);
+			nodenum2=rng.randint(first_nonsensor,nodes.size()-1);
 
 			//Find the first node
 			thenode1=nodes.begin();
@@ -1684,22 +1765,15 @@ bool Genome::mutate_add_link(std::vector<Innovation*> &innovs,double &curinnov,i
 			nodep1=(*thenode1);
 			nodep2=(*thenode2);
 
-			//See if a link already exists  ALSO STOP AT END OF GENES!!!!
-			thegene=genes.begin();
-			while ((thegene!=genes.end()) && 
-				((nodep2->type)!=SENSOR) &&   //Don't allow SENSORS to get input
-				(!((((*thegene)->lnk)->in_node==nodep1)&&
-				(((*thegene)->lnk)->out_node==nodep2)&&
-				(!(((*thegene)->lnk)->is_recurrent))))) {
-					++thegene;
-				}
-
-				if (thegene!=genes.end())
+			//See if a link already exists
+			//Don't allow SENSORS to get input
+				if ((((nodep2->type)==SENSOR)&&(!genes.empty()))||
+					(links.count(link_key(nodep1->node_id,nodep2->node_id))))
 					trycount++;
 				else {
 
 					count=0;
-					recurflag=phenotype->is_recur(nodep1->analogue,nodep2->analogue,count,thresh);
+					recurflag=graph.is_recur(nodenum1,nodenum2,count,thresh);
 
 					//ADDED: CONSIDER connections out of outputs recurrent
 					if (((nodep1->type)==OUTPUT)||
@@ -1728,78 +1802,46 @@ bool Genome::mutate_add_link(std::vector<Innovation*> &innovs,double &curinnov,i
 	//Continue only if an open link was found
 	if (found) {
 
-		//Check to see if this innovation already occured in the population
-		theinnov=innovs.begin();
-
 		//If it was supposed to be recurrent, make sure it gets labeled that way
 		if (do_recur) recurflag=1;
 
-		done=false;
-
-		while(!done) {
-
-			//The innovation is totally novel
-			if (theinnov==innovs.end()) {
-
-				//If the phenotype does not exist, exit on false,print error
-				//Note: This should never happen- if it does there is a bug
-				if (phenotype==0) {
-					//cout<<"ERROR: Attempt to add link to genome with no phenotype"<<std::endl;
-					return false;
-				}
-
-				//Useful for debugging
-				//cout<<"nodep1 id: "<<nodep1->node_id<<std::endl;
-				//cout<<"nodep1: "<<nodep1<<std::endl;
-				//cout<<"nodep1 analogue: "<<nodep1->analogue<<std::endl;
-				//cout<<"nodep2 id: "<<nodep2->node_id<<std::endl;
-				//cout<<"nodep2: "<<nodep2<<std::endl;
-				//cout<<"nodep2 analogue: "<<nodep2->analogue<<std::endl;
-				//cout<<"recurflag: "<<recurflag<<std::endl;
-
-				//NOTE: Something like this could be used for time delays,
-				//      which are not yet supported.  However, this does not
-				//      have an application with recurrency.
-				//If not recurrent, randomize recurrency
-				//if (!recurflag) 
-				//  if (randfloat()<recur_prob) recurflag=1;
-
-				//Choose a random trait
-				traitnum=randint(0,(traits.size())-1);
-				thetrait=traits.begin();
+		//Check to see if this innovation already occured in the population
+		std::lock_guard<std::mutex> lock(innovs.mutex);
 
-				//Choose the new weight
-				//newweight=(gaussrand())/1.5;  //Could use a gaussian
-				newweight=randposneg()*randfloat()*1.0; //used to be 10.0
+		theinnov=innovs.find_link(nodep1->node_id,nodep2->node_id,(bool)recurflag);
 
-				//Create the new gene
-				newgene=new Gene(((thetrait[traitnum])),newweight,nodep1,nodep2,recurflag,curinnov,newweight);
+		//The innovation is totally novel
+		if (theinnov==0) {
 
-				//Add the innovation
-				innovs.push_back(new Innovation(nodep1->node_id,nodep2->node_id,curinnov,newweight,traitnum));
+			//NOTE: Something like this could be used for time delays,
+			//      which are not yet supported.  However, this does not
+			//      have an application with recurrency.
+			//If not recurrent, randomize recurrency
+			//if (!recurflag) 
+			//  if (randfloat()<recur_prob) recurflag=1;
 
-				curinnov=curinnov+1.0;
+			//Choose a random trait
+			traitnum=rng.randint(0,(traits.size())-1);
+			thetrait=traits.begin();
 
-				done=true;
-			}
-			//OTHERWISE, match the innovation in the innovs list
-			else if (((*theinnov)->innovation_type==NEWLINK)&&
-				((*theinnov)->node_in_id==(nodep1->node_id))&&
-				((*theinnov)->node_out_id==(nodep2->node_id))&&
-				((*theinnov)->recur_flag==(bool)recurflag)) {
+			//Choose the new weight
+			//newweight=(gaussrand())/1.5;  //Could use a gaussian
+			newweight=rng.randposneg()*rng.randfloat()*1.0; //used to be 10.0
 
-					thetrait=traits.begin();
+			//Create the new gene
+			newgene=new Gene(((thetrait[traitnum])),newweight,nodep1,nodep2,recurflag,curinnov,newweight);
 
-					//Create new gene
-					newgene=new Gene(((thetrait[(*theinnov)->new_traitnum])),(*theinnov)->new_weight,nodep1,nodep2,recurflag,(*theinnov)->innovation_num1,0);
+			//Add the innovation
+			innovs.add(new Innovation(nodep1->node_id,nodep2->node_id,curinnov,newweight,traitnum));
 
-					done=true;
+			curinnov=curinnov+1.0;
+		}
+		//OTHERWISE, match the innovation of this generation
+		else {
+			thetrait=traits.begin();
 
-				}
-			else {
-				//Keep looking for a matching innovation from this generation
-				++theinnov;
-			}
+			//Create new gene
+			newgene=new Gene(((thetrait[theinnov->new_traitnum])),theinnov->new_weight,nodep1,nodep2,recurflag,theinnov->innovation_num1,0);
 		}
 
 		//Now add the new Genes to the Genome
@@ -1816,7 +1858,7 @@ bool Genome::mutate_add_link(std::vector<Innovation*> &innovs,double &curinnov,i
 }
 
 
-void Genome::mutate_add_sensor(std::vector<Innovation*> &innovs,double &curinnov) {
+void Genome::mutate_add_sensor(InnovationDatabase &innovs,double &curinnov,RNG &rng) {
 
 	std::vector<NNode*> sensors;
 	std::vector<NNode*> outputs;
@@ -1831,14 +1873,13 @@ void Genome::mutate_add_sensor(std::vector<Innovation*> &innovs,double &curinnov
 	int i,j; //counters
 	bool found;
 
-	bool done;	
 
 	int outputConnections;
 
 	std::vector<Trait*>::iterator thetrait;
 	int traitnum;
 
-	std::vector<Innovation*>::iterator theinnov; //For finding a historical match
+	Innovation *theinnov; //For finding a historical match
 
 	//Find all the sensors and outputs
 	for (i = 0; i < nodes.size(); i++) {
@@ -1877,7 +1918,7 @@ void Genome::mutate_add_sensor(std::vector<Innovation*> &innovs,double &curinnov
 		return;
 
 	//Pick randomly from remaining sensors
-	sensor=sensors[randint(0,sensors.size()-1)];
+	sensor=sensors[rng.randint(0,sensors.size()-1)];
 
 	//Add new links to chosen sensor, avoiding redundancy
 	for (int i = 0; i < outputs.size(); i++) {
@@ -1893,55 +1934,45 @@ void Genome::mutate_add_sensor(std::vector<Innovation*> &innovs,double &curinnov
 
 		//Record the innovation
 		if (!found) {
-			theinnov=innovs.begin();
-			done=false;
+			std::lock_guard<std::mutex> lock(innovs.mutex);
 
-			while (!done) {
-				//The innovation is novel
-				if (theinnov==innovs.end()) {
+			theinnov=innovs.find_link(sensor->node_id,output->node_id,false);
 
-					//Choose a random trait
-					traitnum=randint(0,(traits.size())-1);
-					thetrait=traits.begin();
+			//The innovation is novel
+			if (theinnov==0) {
 
-					//Choose the new weight
-					//newweight=(gaussrand())/1.5;  //Could use a gaussian
-					newweight=randposneg()*randfloat()*3.0; //used to be 10.0
-
-					//Create the new gene
-					newgene=new Gene(((thetrait[traitnum])),
-						newweight,sensor,output,false,
-						curinnov,newweight);
+				//Choose a random trait
+				traitnum=rng.randint(0,(traits.size())-1);
+				thetrait=traits.begin();
 
-					//Add the innovation
-					innovs.push_back(new Innovation(sensor->node_id,
-						output->node_id,curinnov,newweight,traitnum));
+				//Choose the new weight
+				//newweight=(gaussrand())/1.5;  //Could use a gaussian
+				newweight=rng.randposneg()*rng.randfloat()*3.0; //used to be 10.0
 
-					curinnov=curinnov+1.0;
+				//Create the new gene
+				newgene=new Gene(((thetrait[traitnum])),
+					newweight,sensor,output,false,
+					curinnov,newweight);
 
-					done=true;
-				} //end novel innovation case
-				//OTHERWISE, match the innovation in the innovs list
-				else if (((*theinnov)->innovation_type==NEWLINK)&&
-					((*theinnov)->node_in_id==(sensor->node_id))&&
-					((*theinnov)->node_out_id==(output->node_id))&&
-					((*theinnov)->recur_flag==false)) {
+				//Add the innovation
+				innovs.add(new Innovation(sensor->node_id,
+					output->node_id,curinnov,newweight,traitnum));
 
-						thetrait=traits.begin();
+				curinnov=curinnov+1.0;
 
-						//Create new gene
-						newgene=
-							new Gene(((thetrait[(*theinnov)->new_traitnum])),
-							(*theinnov)->new_weight,sensor,output,
-							false,(*theinnov)->innovation_num1,0);
+			} //end novel innovation case
+			//OTHERWISE, match the innovation of this generation
+			else {
 
-						done=true;
+				thetrait=traits.begin();
 
-					} //end prior innovation case
-					//Keep looking for matching innovation
-				else ++theinnov;
+				//Create new gene
+				newgene=
+					new Gene(((thetrait[theinnov->new_traitnum])),
+					theinnov->new_weight,sensor,output,
+					false,theinnov->innovation_num1,0);
 
-			}  //end while
+			} //end prior innovation case
 
 			//genes.push_back(newgene);
 			add_gene(genes,newgene);  //adds the gene in correct order
@@ -1993,15 +2024,13 @@ void Genome::node_insert(std::vector<NNode*> &nlist,NNode *n) {
 
 }
 
-Genome *Genome::mate_multipoint(Genome *g,int genomeid,double fitness1,double fitness2, bool interspec_flag) {
+Genome *Genome::mate_multipoint(Genome *g,int genomeid,double fitness1,double fitness2, bool interspec_flag,RNG &rng) {
 	//The baby Genome will contain these new Traits, NNodes, and Genes
 	std::vector<Trait*> newtraits; 
 	std::vector<NNode*> newnodes;   
 	std::vector<Gene*> newgenes;    
 	Genome *new_genome;
 
-	std::vector<Gene*>::iterator curgene2;  //Checks for link duplication
-
 	//iterators for moving through the two parents' traits
 	std::vector<Trait*>::iterator p1trait;
 	std::vector<Trait*>::iterator p2trait;
@@ -2014,12 +2043,9 @@ Genome *Genome::mate_multipoint(Genome *g,int genomeid,double fitness1,double fi
 	double p2innov;
 	Gene *chosengene;  //Gene chosen for baby to inherit
 	int traitnum;  //Number of trait new gene points to
-	NNode *inode;  //NNodes connected to the chosen Gene
-	NNode *onode;
-	NNode *new_inode;
+	NNode *new_inode;  //NNodes connected to the chosen Gene
 	NNode *new_onode;
-	std::vector<NNode*>::iterator curnode;  //For checking if NNodes exist already 
-	int nodetraitnum;  //Trait number for a NNode
+	std::vector<NNode*>::iterator curnode;
 
 	bool disable;  //Set to true if we want to disabled a chosen gene
 
@@ -2040,6 +2066,9 @@ Genome *Genome::mate_multipoint(Genome *g,int genomeid,double fitness1,double fi
 		++p2trait;
 	}
 
+	//Looks up the links and nodes the baby already has
+	crossover_index inherited(newnodes,newtraits,(*(traits.begin()))->trait_id,this,g);
+
 	//Figure out which genome is better
 	//The worse genome should not be allowed to add extra structural baggage
 	//If they are the same, use the smaller one's disjoint and excess genes only
@@ -2058,16 +2087,8 @@ Genome *Genome::mate_multipoint(Genome *g,int genomeid,double fitness1,double fi
 		if ((((*curnode)->gen_node_label)==INPUT)||
 			(((*curnode)->gen_node_label)==BIAS)||
 			(((*curnode)->gen_node_label)==OUTPUT)) {
-				if (!((*curnode)->nodetrait)) nodetraitnum=0;
-				else
-					nodetraitnum=(((*curnode)->nodetrait)->trait_id)-(*(traits.begin()))->trait_id;
-
 				//Create a new node off the sensor or output
-				new_onode=new NNode((*curnode),newtraits[nodetraitnum]);
-
-				//Add the new node
-				node_insert(newnodes,new_onode);
-
+				inherited.get_node(*curnode);
 			}
 
 	}
@@ -2098,7 +2119,7 @@ Genome *Genome::mate_multipoint(Genome *g,int genomeid,double fitness1,double fi
 				p2innov=(*p2gene)->innovation_num;
 
 				if (p1innov==p2innov) {
-					if (randfloat()<0.5) {
+					if (rng.randfloat()<0.5) {
 						chosengene=*p1gene;
 					}
 					else {
@@ -2109,7 +2130,7 @@ Genome *Genome::mate_multipoint(Genome *g,int genomeid,double fitness1,double fi
 					//will likely be disabled
 					if ((((*p1gene)->enable)==false)||
 						(((*p2gene)->enable)==false)) 
-						if (randfloat()<0.75) disable=true;
+						if (rng.randfloat()<0.75) disable=true;
 
 					++p1gene;
 					++p2gene;
@@ -2139,20 +2160,8 @@ Genome *Genome::mate_multipoint(Genome *g,int genomeid,double fitness1,double fi
 			*/
 
 			//Check to see if the chosengene conflicts with an already chosen gene
-			//i.e. do they represent the same link    
-			curgene2=newgenes.begin();
-			while ((curgene2!=newgenes.end())&&
-				(!((((((*curgene2)->lnk)->in_node)->node_id)==((((chosengene)->lnk)->in_node)->node_id))&&
-				(((((*curgene2)->lnk)->out_node)->node_id)==((((chosengene)->lnk)->out_node)->node_id))&&((((*curgene2)->lnk)->is_recurrent)== (((chosengene)->lnk)->is_recurrent)) ))&&
-				(!((((((*curgene2)->lnk)->in_node)->node_id)==((((chosengene)->lnk)->out_node)->node_id))&&
-				(((((*curgene2)->lnk)->out_node)->node_id)==((((chosengene)->lnk)->in_node)->node_id))&&
-				(!((((*curgene2)->lnk)->is_recurrent)))&&
-				(!((((chosengene)->lnk)->is_recurrent))) )))
-			{	
-				++curgene2;
-			}
-
-			if (curgene2!=newgenes.end()) skip=true;  //Links conflicts, abort adding
+			//i.e. do they represent the same link
+			if (inherited.conflicts(chosengene)) skip=true;  //Links conflicts, abort adding
 
 			if (!skip) {
 
@@ -2164,108 +2173,8 @@ Genome *Genome::mate_multipoint(Genome *g,int genomeid,double fitness1,double fi
 					traitnum=(((chosengene->lnk)->linktrait)->trait_id)-(*(traits.begin()))->trait_id;  //The subtracted number normalizes depending on whether traits start counting at 1 or 0
 
 				//Next check for the nodes, add them if not in the baby Genome already
-				inode=(chosengene->lnk)->in_node;
-				onode=(chosengene->lnk)->out_node;
-
-				//Check for inode in the newnodes list
-				if (inode->node_id<onode->node_id) {
-					//inode before onode
-
-					//Checking for inode's existence
-					curnode=newnodes.begin();
-					while((curnode!=newnodes.end())&&
-						((*curnode)->node_id!=inode->node_id)) 
-						++curnode;
-
-					if (curnode==newnodes.end()) {
-						//Here we know the node doesn't exist so we have to add it
-						//(normalized trait number for new NNode)
-
-						//old buggy version:
-						// if (!(onode->nodetrait)) nodetraitnum=((*(traits.begin()))->trait_id);
-						if (!(inode->nodetrait)) nodetraitnum=0;
-						else
-							nodetraitnum=((inode->nodetrait)->trait_id)-((*(traits.begin()))->trait_id);			       
-
-						new_inode=new NNode(inode,newtraits[nodetraitnum]);
-						node_insert(newnodes,new_inode);
-
-					}
-					else {
-						new_inode=(*curnode);
-
-					}
-
-					//Checking for onode's existence
-					curnode=newnodes.begin();
-					while((curnode!=newnodes.end())&&
-						((*curnode)->node_id!=onode->node_id)) 
-						++curnode;
-					if (curnode==newnodes.end()) {
-						//Here we know the node doesn't exist so we have to add it
-						//normalized trait number for new NNode
-
-						if (!(onode->nodetrait)) nodetraitnum=0;
-						else
-							nodetraitnum=((onode->nodetrait)->trait_id)-(*(traits.begin()))->trait_id;			       
-
-						new_onode=new NNode(onode,newtraits[nodetraitnum]);
-
-						node_insert(newnodes,new_onode);
-
-					}
-					else {
-						new_onode=(*curnode);
-					}
-
-				}
-				//If the onode has a higher id than the inode we want to add it first
-				else {
-					//Checking for onode's existence
-					curnode=newnodes.begin();
-					while((curnode!=newnodes.end())&&
-						((*curnode)->node_id!=onode->node_id)) 
-						++curnode;
-					if (curnode==newnodes.end()) {
-						//Here we know the node doesn't exist so we have to add it
-						//normalized trait number for new NNode
-						if (!(onode->nodetrait)) nodetraitnum=0;
-						else
-							nodetraitnum=((onode->nodetrait)->trait_id)-(*(traits.begin()))->trait_id;			       
-
-						new_onode=new NNode(onode,newtraits[nodetraitnum]);
-						//newnodes.push_back(new_onode);
-						node_insert(newnodes,new_onode);
-
-					}
-					else {
-						new_onode=(*curnode);
-
-					}
-
-					//Checking for inode's existence
-					curnode=newnodes.begin();
-					while((curnode!=newnodes.end())&&
-						((*curnode)->node_id!=inode->node_id)) 
-						++curnode;
-					if (curnode==newnodes.end()) {
-						//Here we know the node doesn't exist so we have to add it
-						//normalized trait number for new NNode
-						if (!(inode->nodetrait)) nodetraitnum=0;
-						else
-							nodetraitnum=((inode->nodetrait)->trait_id)-(*(traits.begin()))->trait_id;			    
-
-						new_inode=new NNode(inode,newtraits[nodetraitnum]);
-
-						node_insert(newnodes,new_inode);
-
-					}
-					else {
-						new_inode=(*curnode);
-
-					}
-
-				} //End NNode checking section- NNodes are now in new Genome
+				new_inode=inherited.get_node((chosengene->lnk)->in_node);
+				new_onode=inherited.get_node((chosengene->lnk)->out_node);
 
 				//Add the Gene
 				newgene=new Gene(chosengene,newtraits[traitnum],new_inode,new_onode);
@@ -2274,10 +2183,12 @@ Genome *Genome::mate_multipoint(Genome *g,int genomeid,double fitness1,double fi
 					disable=false;
 				}
 				newgenes.push_back(newgene);
+				inherited.add_link(newgene);
 			}
 
 		}
 
+		inherited.sort_nodes();
 		new_genome=new Genome(genomeid,newtraits,newnodes,newgenes);
 
 		//Return the baby Genome
@@ -2285,7 +2196,7 @@ Genome *Genome::mate_multipoint(Genome *g,int genomeid,double fitness1,double fi
 
 }
 
-Genome *Genome::mate_multipoint_avg(Genome *g,int genomeid,double fitness1,double fitness2,bool interspec_flag) {
+Genome *Genome::mate_multipoint_avg(Genome *g,int genomeid,double fitness1,double fitness2,bool interspec_flag,RNG &rng) {
 	//The baby Genome will contain these new Traits, NNodes, and Genes
 	std::vector<Trait*> newtraits;
 	std::vector<NNode*> newnodes;
@@ -2296,8 +2207,6 @@ Genome *Genome::mate_multipoint_avg(Genome *g,int genomeid,double fitness1,doubl
 	std::vector<Trait*>::iterator p2trait;
 	Trait *newtrait;
 
-	std::vector<Gene*>::iterator curgene2; //Checking for link duplication
-
 	//iterators for moving through the two parents' genes
 	std::vector<Gene*>::iterator p1gene;
 	std::vector<Gene*>::iterator p2gene;
@@ -2305,13 +2214,10 @@ Genome *Genome::mate_multipoint_avg(Genome *g,int genomeid,double fitness1,doubl
 	double p2innov;
 	Gene *chosengene;  //Gene chosen for baby to inherit
 	int traitnum;  //Number of trait new gene points to
-	NNode *inode;  //NNodes connected to the chosen Gene
-	NNode *onode;
-	NNode *new_inode;
+	NNode *new_inode;  //NNodes connected to the chosen Gene
 	NNode *new_onode;
 
-	std::vector<NNode*>::iterator curnode;  //For checking if NNodes exist already 
-	int nodetraitnum;  //Trait number for a NNode
+	std::vector<NNode*>::iterator curnode;
 
 	//This Gene is used to hold the average of the two genes to be averaged
 	Gene *avgene;
@@ -2343,6 +2249,9 @@ Genome *Genome::mate_multipoint_avg(Genome *g,int genomeid,double fitness1,doubl
 		++p2trait;
 	}
 
+	//Looks up the links and nodes the baby already has
+	crossover_index inherited(newnodes,newtraits,(*(traits.begin()))->trait_id,this,g);
+
 	//Set up the avgene
 	avgene=new Gene(0,0,0,0,0,0,0);
 
@@ -2351,16 +2260,8 @@ Genome *Genome::mate_multipoint_avg(Genome *g,int genomeid,double fitness1,doubl
 		if ((((*curnode)->gen_node_label)==INPUT)||
 			(((*curnode)->gen_node_label)==OUTPUT)||
 			(((*curnode)->gen_node_label)==BIAS)) {
-				if (!((*curnode)->nodetrait)) nodetraitnum=0;
-				else
-					nodetraitnum=(((*curnode)->nodetrait)->trait_id)-(*(traits.begin()))->trait_id;
-
 				//Create a new node off the sensor or output
-				new_onode=new NNode((*curnode),newtraits[nodetraitnum]);
-
-				//Add the new node
-				node_insert(newnodes,new_onode);
-
+				inherited.get_node(*curnode);
 			}
 
 	}
@@ -2409,7 +2310,7 @@ Genome *Genome::mate_multipoint_avg(Genome *g,int genomeid,double fitness1,doubl
 
 				if (p1innov==p2innov) {
 					//Average them into the avgene
-					if (randfloat()>0.5) (avgene->lnk)->linktrait=((*p1gene)->lnk)->linktrait;
+					if (rng.randfloat()>0.5) (avgene->lnk)->linktrait=((*p1gene)->lnk)->linktrait;
 					else (avgene->lnk)->linktrait=((*p2gene)->lnk)->linktrait;
 
 					//WEIGHTS AVERAGED HERE
@@ -2440,13 +2341,13 @@ Genome *Genome::mate_multipoint_avg(Genome *g,int genomeid,double fitness1,doubl
 					//(avgene->lnk)->weight=blx_min+blx_pos*blx_range;
 					//
 
-					if (randfloat()>0.5) (avgene->lnk)->in_node=((*p1gene)->lnk)->in_node;
+					if (rng.randfloat()>0.5) (avgene->lnk)->in_node=((*p1gene)->lnk)->in_node;
 					else (avgene->lnk)->in_node=((*p2gene)->lnk)->in_node;
 
-					if (randfloat()>0.5) (avgene->lnk)->out_node=((*p1gene)->lnk)->out_node;
+					if (rng.randfloat()>0.5) (avgene->lnk)->out_node=((*p1gene)->lnk)->out_node;
 					else (avgene->lnk)->out_node=((*p2gene)->lnk)->out_node;
 
-					if (randfloat()>0.5) (avgene->lnk)->is_recurrent=((*p1gene)->lnk)->is_recurrent;
+					if (rng.randfloat()>0.5) (avgene->lnk)->is_recurrent=((*p1gene)->lnk)->is_recurrent;
 					else (avgene->lnk)->is_recurrent=((*p2gene)->lnk)->is_recurrent;
 
 					avgene->innovation_num=(*p1gene)->innovation_num;
@@ -2454,7 +2355,7 @@ Genome *Genome::mate_multipoint_avg(Genome *g,int genomeid,double fitness1,doubl
 
 					if ((((*p1gene)->enable)==false)||
 						(((*p2gene)->enable)==false)) 
-						if (randfloat()<0.75) avgene->enable=false;
+						if (rng.randfloat()<0.75) avgene->enable=false;
 
 					chosengene=avgene;
 					++p1gene;
@@ -2484,28 +2385,10 @@ Genome *Genome::mate_multipoint_avg(Genome *g,int genomeid,double fitness1,doubl
 			*/
 
 			//Check to see if the chosengene conflicts with an already chosen gene
-			//i.e. do they represent the same link    
-			curgene2=newgenes.begin();
-			while ((curgene2!=newgenes.end()))
-
-			{
-
-				if (((((((*curgene2)->lnk)->in_node)->node_id)==((((chosengene)->lnk)->in_node)->node_id))&&
-					(((((*curgene2)->lnk)->out_node)->node_id)==((((chosengene)->lnk)->out_node)->node_id))&&
-					((((*curgene2)->lnk)->is_recurrent)== (((chosengene)->lnk)->is_recurrent)))||
-					((((((*curgene2)->lnk)->out_node)->node_id)==((((chosengene)->lnk)->in_node)->node_id))&&
-					(((((*curgene2)->lnk)->in_node)->node_id)==((((chosengene)->lnk)->out_node)->node_id))&&
-					(!((((*curgene2)->lnk)->is_recurrent)))&&
-					(!((((chosengene)->lnk)->is_recurrent)))     ))
-				{ 
-					skip=true;
-
-				}
-				++curgene2;
-			}
+			//i.e. do they represent the same link
+			if (inherited.conflicts(chosengene)) skip=true;  //Link is a duplicate
 
 			if (!skip) {
-
 				//Now add the chosengene to the baby
 
 				//First, get the trait pointer
@@ -2514,117 +2397,28 @@ Genome *Genome::mate_multipoint_avg(Genome *g,int genomeid,double fitness1,doubl
 					traitnum=(((chosengene->lnk)->linktrait)->trait_id)-(*(traits.begin()))->trait_id;  //The subtracted number normalizes depending on whether traits start counting at 1 or 0
 
 				//Next check for the nodes, add them if not in the baby Genome already
-				inode=(chosengene->lnk)->in_node;
-				onode=(chosengene->lnk)->out_node;
-
-				//Check for inode in the newnodes list
-				if (inode->node_id<onode->node_id) {
-
-					//Checking for inode's existence
-					curnode=newnodes.begin();
-					while((curnode!=newnodes.end())&&
-						((*curnode)->node_id!=inode->node_id)) 
-						++curnode;
-
-					if (curnode==newnodes.end()) {
-						//Here we know the node doesn't exist so we have to add it
-						//normalized trait number for new NNode
-
-						if (!(inode->nodetrait)) nodetraitnum=0;
-						else
-							nodetraitnum=((inode->nodetrait)->trait_id)-((*(traits.begin()))->trait_id);			       
-
-						new_inode=new NNode(inode,newtraits[nodetraitnum]);
-
-						node_insert(newnodes,new_inode);
-					}
-					else {
-						new_inode=(*curnode);
-
-					}
-
-					//Checking for onode's existence
-					curnode=newnodes.begin();
-					while((curnode!=newnodes.end())&&
-						((*curnode)->node_id!=onode->node_id)) 
-						++curnode;
-					if (curnode==newnodes.end()) {
-						//Here we know the node doesn't exist so we have to add it
-						//normalized trait number for new NNode
-
-						if (!(onode->nodetrait)) nodetraitnum=0;
-						else
-							nodetraitnum=((onode->nodetrait)->trait_id)-(*(traits.begin()))->trait_id;			
-						new_onode=new NNode(onode,newtraits[nodetraitnum]);
-
-						node_insert(newnodes,new_onode);
-					}
-					else {
-						new_onode=(*curnode);
-					}
-				}
-				//If the onode has a higher id than the inode we want to add it first
-				else {
-					//Checking for onode's existence
-					curnode=newnodes.begin();
-					while((curnode!=newnodes.end())&&
-						((*curnode)->node_id!=onode->node_id)) 
-						++curnode;
-					if (curnode==newnodes.end()) {
-						//Here we know the node doesn't exist so we have to add it
-						//normalized trait number for new NNode
-						if (!(onode->nodetrait)) nodetraitnum=0;
-						else
-							nodetraitnum=((onode->nodetrait)->trait_id)-(*(traits.begin()))->trait_id;			       
-
-						new_onode=new NNode(onode,newtraits[nodetraitnum]);
-
-						node_insert(newnodes,new_onode);
-					}
-					else {
-						new_onode=(*curnode);
-					}
-
-					//Checking for inode's existence
-					curnode=newnodes.begin();
-					while((curnode!=newnodes.end())&&
-						((*curnode)->node_id!=inode->node_id)) 
-						++curnode;
-					if (curnode==newnodes.end()) {
-						//Here we know the node doesn't exist so we have to add it
-						//normalized trait number for new NNode
-						if (!(inode->nodetrait)) nodetraitnum=0;
-						else
-							nodetraitnum=((inode->nodetrait)->trait_id)-(*(traits.begin()))->trait_id;			       
-
-						new_inode=new NNode(inode,newtraits[nodetraitnum]);
-
-						node_insert(newnodes,new_inode);
-					}
-					else {
-						new_inode=(*curnode);
-
-					}
-
-				} //End NNode checking section- NNodes are now in new Genome
+				new_inode=inherited.get_node((chosengene->lnk)->in_node);
+				new_onode=inherited.get_node((chosengene->lnk)->out_node);
 
 				//Add the Gene
 				newgene=new Gene(chosengene,newtraits[traitnum],new_inode,new_onode);
 
 				newgenes.push_back(newgene);
+				inherited.add_link(newgene);
 
 			}  //End if which checked for link duplicationb
 
 		}
 
 		delete avgene;  //Clean up used object
+		inherited.sort_nodes();
 
 		//Return the baby Genome
 		return (new Genome(genomeid,newtraits,newnodes,newgenes));
 
 }
 
-Genome *Genome::mate_singlepoint(Genome *g,int genomeid) {
+Genome *Genome::mate_singlepoint(Genome *g,int genomeid,RNG &rng) {
 	//The baby Genome will contain these new Traits, NNodes, and Genes
 	std::vector<Trait*> newtraits; 
 	std::vector<NNode*> newnodes;   
@@ -2635,8 +2429,6 @@ Genome *Genome::mate_singlepoint(Genome *g,int genomeid) {
 	std::vector<Trait*>::iterator p2trait;
 	Trait *newtrait;
 
-	std::vector<Gene*>::iterator curgene2;  //Check for link duplication
-
 	//iterators for moving through the two parents' genes
 	std::vector<Gene*>::iterator p1gene;
 	std::vector<Gene*>::iterator p2gene;
@@ -2647,12 +2439,8 @@ Genome *Genome::mate_singlepoint(Genome *g,int genomeid) {
 	double p2innov;
 	Gene *chosengene;  //Gene chosen for baby to inherit
 	int traitnum;  //Number of trait new gene points to
-	NNode *inode;  //NNodes connected to the chosen Gene
-	NNode *onode;
-	NNode *new_inode;
+	NNode *new_inode;  //NNodes connected to the chosen Gene
 	NNode *new_onode;
-	std::vector<NNode*>::iterator curnode;  //For checking if NNodes exist already 
-	int nodetraitnum;  //Trait number for a NNode
 
 	//This Gene is used to hold the average of the two genes to be averaged
 	Gene *avgene;
@@ -2670,12 +2458,15 @@ Genome *Genome::mate_singlepoint(Genome *g,int genomeid) {
 		++p2trait;
 	}
 
+	//Looks up the links and nodes the baby already has
+	crossover_index inherited(newnodes,newtraits,(*(traits.begin()))->trait_id,this,g);
+
 	//Set up the avgene
 	avgene=new Gene(0,0,0,0,0,0,0);
 
 	//Decide where to cross  (p1gene will always be in smaller Genome)
 	if (genes.size()<(g->genes).size()) {
-		crosspoint=randint(0,(genes.size())-1);
+		crosspoint=rng.randint(0,(genes.size())-1);
 		p1gene=genes.begin();
 		p2gene=(g->genes).begin();
 		stopper=(g->genes).end();
@@ -2683,7 +2474,7 @@ Genome *Genome::mate_singlepoint(Genome *g,int genomeid) {
 		p2stop=(g->genes).end();
 	}
 	else {
-		crosspoint=randint(0,((g->genes).size())-1);
+		crosspoint=rng.randint(0,((g->genes).size())-1);
 		p2gene=genes.begin();
 		p1gene=(g->genes).begin();
 		stopper=genes.end();
@@ -2732,20 +2523,20 @@ Genome *Genome::mate_singlepoint(Genome *g,int genomeid) {
 				else {
 
 					//Average them into the avgene
-					if (randfloat()>0.5) (avgene->lnk)->linktrait=((*p1gene)->lnk)->linktrait;
+					if (rng.randfloat()>0.5) (avgene->lnk)->linktrait=((*p1gene)->lnk)->linktrait;
 					else (avgene->lnk)->linktrait=((*p2gene)->lnk)->linktrait;
 
 					//WEIGHTS AVERAGED HERE
 					(avgene->lnk)->weight=(((*p1gene)->lnk)->weight+((*p2gene)->lnk)->weight)/2.0;
 
 
-					if (randfloat()>0.5) (avgene->lnk)->in_node=((*p1gene)->lnk)->in_node;
+					if (rng.randfloat()>0.5) (avgene->lnk)->in_node=((*p1gene)->lnk)->in_node;
 					else (avgene->lnk)->in_node=((*p2gene)->lnk)->in_node;
 
-					if (randfloat()>0.5) (avgene->lnk)->out_node=((*p1gene)->lnk)->out_node;
+					if (rng.randfloat()>0.5) (avgene->lnk)->out_node=((*p1gene)->lnk)->out_node;
 					else (avgene->lnk)->out_node=((*p2gene)->lnk)->out_node;
 
-					if (randfloat()>0.5) (avgene->lnk)->is_recurrent=((*p1gene)->lnk)->is_recurrent;
+					if (rng.randfloat()>0.5) (avgene->lnk)->is_recurrent=((*p1gene)->lnk)->is_recurrent;
 					else (avgene->lnk)->is_recurrent=((*p2gene)->lnk)->is_recurrent;
 
 					avgene->innovation_num=(*p1gene)->innovation_num;
@@ -2781,23 +2572,8 @@ Genome *Genome::mate_singlepoint(Genome *g,int genomeid) {
 		}
 
 		//Check to see if the chosengene conflicts with an already chosen gene
-		//i.e. do they represent the same link    
-		curgene2=newgenes.begin();
-
-		while ((curgene2!=newgenes.end())&&
-			(!((((((*curgene2)->lnk)->in_node)->node_id)==((((chosengene)->lnk)->in_node)->node_id))&&
-			(((((*curgene2)->lnk)->out_node)->node_id)==((((chosengene)->lnk)->out_node)->node_id))&&((((*curgene2)->lnk)->is_recurrent)== (((chosengene)->lnk)->is_recurrent)) ))&&
-			(!((((((*curgene2)->lnk)->in_node)->node_id)==((((chosengene)->lnk)->out_node)->node_id))&&
-			(((((*curgene2)->lnk)->out_node)->node_id)==((((chosengene)->lnk)->in_node)->node_id))&&
-			(!((((*curgene2)->lnk)->is_recurrent)))&&
-			(!((((chosengene)->lnk)->is_recurrent))) )))
-		{
-
-			++curgene2;
-		}
-
-
-		if (curgene2!=newgenes.end()) skip=true;  //Link is a duplicate
+		//i.e. do they represent the same link
+		if (inherited.conflicts(chosengene)) skip=true;  //Link is a duplicate
 
 		if (!skip) {
 			//Now add the chosengene to the baby
@@ -2808,101 +2584,12 @@ Genome *Genome::mate_singlepoint(Genome *g,int genomeid) {
 				traitnum=(((chosengene->lnk)->linktrait)->trait_id)-(*(traits.begin()))->trait_id;  //The subtracted number normalizes depending on whether traits start counting at 1 or 0
 
 			//Next check for the nodes, add them if not in the baby Genome already
-			inode=(chosengene->lnk)->in_node;
-			onode=(chosengene->lnk)->out_node;
-
-			//Check for inode in the newnodes list
-			if (inode->node_id<onode->node_id) {
-				//cout<<"inode before onode"<<std::endl;
-				//Checking for inode's existence
-				curnode=newnodes.begin();
-				while((curnode!=newnodes.end())&&
-					((*curnode)->node_id!=inode->node_id)) 
-					++curnode;
-
-				if (curnode==newnodes.end()) {
-					//Here we know the node doesn't exist so we have to add it
-					//normalized trait number for new NNode
-
-					if (!(inode->nodetrait)) nodetraitnum=0;
-					else
-						nodetraitnum=((inode->nodetrait)->trait_id)-((*(traits.begin()))->trait_id);			       
-
-					new_inode=new NNode(inode,newtraits[nodetraitnum]);
-
-					node_insert(newnodes,new_inode);
-				}
-				else {
-					new_inode=(*curnode);
-				}
-
-				//Checking for onode's existence
-				curnode=newnodes.begin();
-				while((curnode!=newnodes.end())&&
-					((*curnode)->node_id!=onode->node_id)) 
-					++curnode;
-				if (curnode==newnodes.end()) {
-					//Here we know the node doesn't exist so we have to add it
-					//normalized trait number for new NNode
-
-					if (!(onode->nodetrait)) nodetraitnum=0;
-					else
-						nodetraitnum=((onode->nodetrait)->trait_id)-(*(traits.begin()))->trait_id;			     
-
-					new_onode=new NNode(onode,newtraits[nodetraitnum]);
-					node_insert(newnodes,new_onode);
-
-				}
-				else {
-					new_onode=(*curnode);
-				}
-			}
-			//If the onode has a higher id than the inode we want to add it first
-			else {
-				//Checking for onode's existence
-				curnode=newnodes.begin();
-				while((curnode!=newnodes.end())&&
-					((*curnode)->node_id!=onode->node_id)) 
-					++curnode;
-				if (curnode==newnodes.end()) {
-					//Here we know the node doesn't exist so we have to add it
-					//normalized trait number for new NNode
-					if (!(onode->nodetrait)) nodetraitnum=0;
-					else
-						nodetraitnum=((onode->nodetrait)->trait_id)-(*(traits.begin()))->trait_id;			       
-
-					new_onode=new NNode(onode,newtraits[nodetraitnum]);
-					node_insert(newnodes,new_onode);
-				}
-				else {
-					new_onode=(*curnode);
-				}
-
-				//Checking for inode's existence
-				curnode=newnodes.begin();
-
-				while((curnode!=newnodes.end())&&
-					((*curnode)->node_id!=inode->node_id)) 
-					++curnode;
-				if (curnode==newnodes.end()) {
-					//Here we know the node doesn't exist so we have to add it
-					//normalized trait number for new NNode
-					if (!(inode->nodetrait)) nodetraitnum=0;
-					else
-						nodetraitnum=((inode->nodetrait)->trait_id)-(*(traits.begin()))->trait_id;			       
-
-					new_inode=new NNode(inode,newtraits[nodetraitnum]);
-					//newnodes.push_back(new_inode);
-					node_insert(newnodes,new_inode);
-				}
-				else {
-					new_inode=(*curnode);
-				}
-
-			} //End NNode checking section- NNodes are now in new Genome
+			new_inode=inherited.get_node((chosengene->lnk)->in_node);
+			new_onode=inherited.get_node((chosengene->lnk)->out_node);
 
 			//Add the Gene
 			newgenes.push_back(new Gene(chosengene,newtraits[traitnum],new_inode,new_onode));
+			inherited.add_link(newgenes.back());
 
 		}  //End of if (!skip)
 
@@ -2912,6 +2599,7 @@ Genome *Genome::mate_singlepoint(Genome *g,int genomeid) {
 
 
 	delete avgene;  //Clean up used object
+	inherited.sort_nodes();
 
 	//Return the baby Genome
 	return (new Genome(genomeid,newtraits,newnodes,newgenes));
@@ -3043,7 +2731,7 @@ int Genome::extrons() {
 	return total;
 }
 
-void Genome::randomize_traits() {
+void Genome::randomize_traits(RNG &rng) {
 
 	int numtraits=traits.size();
 	int traitnum; //number of selected random trait
@@ -3053,7 +2741,7 @@ void Genome::randomize_traits() {
 
 	//Go through all nodes and randomize their trait pointers
 	for(curnode=nodes.begin();curnode!=nodes.end();++curnode) {
-		traitnum=randint(1,numtraits); //randomize trait
+		traitnum=rng.randint(1,numtraits); //randomize trait
 		(*curnode)->trait_id=traitnum;
 
 		curtrait=traits.begin();
@@ -3067,7 +2755,7 @@ void Genome::randomize_traits() {
 
 	//Go through all connections and randomize their trait pointers
 	for(curgene=genes.begin();curgene!=genes.end();++curgene) {
-		traitnum=randint(1,numtraits); //randomize trait
+		traitnum=rng.randint(1,numtraits); //randomize trait
 		(*curgene)->lnk->trait_id=traitnum;
 
 		curtrait=traits.begin();
@@ -17,8 +17,10 @@
 #define _GENOME_H_
 
 #include <vector>
+#include "compiled_network.h"
 #include "gene.h"
 #include "innovation.h"
+#include "pool.h"
 
 namespace NEAT {
 
@@ -41,7 +43,7 @@ namespace NEAT {
 	//    list of Genes provide an evolutionary history of innovation and     
 	//    link-building.
 
-	class Genome {
+	class Genome : public PoolAllocated<Genome> {
 
 	public:
 		int genome_id;
@@ -76,7 +78,7 @@ namespace NEAT {
 		// be included. 
 		// The last input is a bias
 		// Linkprob is the probability of a link  
-		Genome(int new_id,int i, int o, int n,int nmax, bool r, double linkprob);
+		Genome(int new_id,int i, int o, int n,int nmax, bool r, double linkprob, RNG &rng);
 
 		//Special constructor that creates a Genome of 3 possible types:
 		//0 - Fully linked, no hidden nodes
@@ -94,6 +96,10 @@ namespace NEAT {
 		//Generate a network phenotype from this Genome with specified id
 		Network *genesis(int);
 
+		//Generate a flat phenotype for fast activation, behaves exactly like
+		//the Network from genesis
+		CompiledNetwork compile() const;
+
 		// Dump this genome to specified file
 		void print_to_file(std::ostream &outFile);
 		void print_to_file(std::ofstream &outFile);
@@ -113,19 +119,19 @@ namespace NEAT {
 		// ******* MUTATORS *******
 
 		// Perturb params in one trait
-		void mutate_random_trait();
+		void mutate_random_trait(RNG &rng);
 
 		// Change random link's trait. Repeat times times
-		void mutate_link_trait(int times);
+		void mutate_link_trait(int times,RNG &rng);
 
 		// Change random node's trait times times 
-		void mutate_node_trait(int times);
+		void mutate_node_trait(int times,RNG &rng);
 
 		// Add Gaussian noise to linkweights either GAUSSIAN or COLDGAUSSIAN (from zero)
-		void mutate_link_weights(double power,double rate,mutator mut_type);
+		void mutate_link_weights(double power,double rate,mutator mut_type,RNG &rng);
 
 		// toggle genes on or off 
-		void mutate_toggle_enable(int times);
+		void mutate_toggle_enable(int times,RNG &rng);
 
 		// Find first disabled gene and enable it 
 		void mutate_gene_reenable();
@@ -136,12 +142,12 @@ namespace NEAT {
 		//   Generally, if they fail, they can be called again if desired. 
 
 		// Mutate genome by adding a node respresentation 
-		bool mutate_add_node(std::vector<Innovation*> &innovs,int &curnode_id,double &curinnov);
+		bool mutate_add_node(InnovationDatabase &innovs,int &curnode_id,double &curinnov,RNG &rng);
 
 		// Mutate the genome by adding a new link between 2 random NNodes 
-		bool mutate_add_link(std::vector<Innovation*> &innovs,double &curinnov,int tries); 
+		bool mutate_add_link(InnovationDatabase &innovs,double &curinnov,int tries,RNG &rng); 
 
-		void mutate_add_sensor(std::vector<Innovation*> &innovs, double &curinnov);
+		void mutate_add_sensor(InnovationDatabase &innovs, double &curinnov,RNG &rng);
 
 		// ****** MATING METHODS ***** 
 
@@ -152,18 +158,18 @@ namespace NEAT {
 		//   the other, the baby will inherit the innovation 
 		//   Interspecies mating leads to all genes being inherited.
 		//   Otherwise, excess genes come from most fit parent.
-		Genome *mate_multipoint(Genome *g,int genomeid,double fitness1, double fitness2, bool interspec_flag);
+		Genome *mate_multipoint(Genome *g,int genomeid,double fitness1, double fitness2, bool interspec_flag,RNG &rng);
 
 		//This method mates like multipoint but instead of selecting one
 		//   or the other when the innovation numbers match, it averages their
 		//   weights 
-		Genome *mate_multipoint_avg(Genome *g,int genomeid,double fitness1,double fitness2, bool interspec_flag);
+		Genome *mate_multipoint_avg(Genome *g,int genomeid,double fitness1,double fitness2, bool interspec_flag,RNG &rng);
 
 		// This method is similar to a standard single point CROSSOVER
 		//   operator.  Traits are averaged as in the previous 2 mating
 		//   methods.  A point is chosen in the smaller Genome for crossing
 		//   with the bigger one.  
-		Genome *mate_singlepoint(Genome *g,int genomeid);
+		Genome *mate_singlepoint(Genome *g,int genomeid,RNG &rng);
 
 
 		// ******** COMPATIBILITY CHECKING METHODS ********
@@ -184,7 +190,7 @@ namespace NEAT {
 		int extrons();
 
 		// Randomize the trait pointers of all the node and connection genes 
-		void randomize_traits();
+		void randomize_traits(RNG &rng);
 
 	protected:
 		//Inserts a NNode into a given ordered list of NNodes in order
@@ -194,6 +200,10 @@ namespace NEAT {
 		//*correct order* into the list of genes in the genome
 		void add_gene(std::vector<Gene*> &glist,Gene *g);
 
+		//The links and NNodes a baby has inherited so far while mating,
+		//looked up in constant time so mating is linear in the genes
+		struct crossover_index;
+
 	};
 
 	//Calls special constructor that creates a Genome of 3 possible types:
@@ -59,3 +59,72 @@ Innovation::Innovation(int nin,int nout,double num1,double w,int t,bool recur) {
 	newnode_id=0;
 	recur_flag=recur;
 }
+
+bool InnovationDatabase::innovation_key::operator==(const innovation_key &other) const {
+	return (innovation_type==other.innovation_type)&&
+		(node_in_id==other.node_in_id)&&
+		(node_out_id==other.node_out_id)&&
+		(old_innov_num==other.old_innov_num)&&
+		(recur_flag==other.recur_flag);
+}
+
+std::size_t InnovationDatabase::innovation_key_hash::operator()(const innovation_key &key) const {
+	std::size_t seed=std::hash<int>()(key.innovation_type);
+	std::size_t values[4]={std::hash<int>()(key.node_in_id),
+		std::hash<int>()(key.node_out_id),
+		std::hash<double>()(key.old_innov_num),
+		std::hash<bool>()(key.recur_flag)};
+
+	for(int count=0;count<4;count++)
+		seed^=values[count]+0x9e3779b9+(seed<<6)+(seed>>2);
+
+	return seed;
+}
+
+Innovation *InnovationDatabase::find_node(int nin,int nout,double oldinnov) const {
+	innovation_key key={NEWNODE,nin,nout,oldinnov,false};
+	std::unordered_map<innovation_key,Innovation*,innovation_key_hash>::const_iterator found=index.find(key);
+
+	if (found==index.end())
+		return 0;
+	return found->second;
+}
+
+Innovation *InnovationDatabase::find_link(int nin,int nout,bool recur) const {
+	innovation_key key={NEWLINK,nin,nout,0.0,recur};
+	std::unordered_map<innovation_key,Innovation*,innovation_key_hash>::const_iterator found=index.find(key);
+
+	if (found==index.end())
+		return 0;
+	return found->second;
+}
+
+void InnovationDatabase::add(Innovation *innov) {
+	innovation_key key;
+
+	//Only the fields a lookup of this type compares are part of the key
+	if (((int) innov->innovation_type)==NEWNODE) {
+		innovation_key node_key={NEWNODE,innov->node_in_id,innov->node_out_id,innov->old_innov_num,false};
+		key=node_key;
+	}
+	else {
+		innovation_key link_key={NEWLINK,innov->node_in_id,innov->node_out_id,0.0,innov->recur_flag};
+		key=link_key;
+	}
+
+	//Like the old list scan, the first of two identical innovations wins
+	index.insert(std::make_pair(key,innov));
+	innovations.push_back(innov);
+}
+
+void InnovationDatabase::clear() {
+	for(std::vector<Innovation*>::iterator curinnov=innovations.begin();curinnov!=innovations.end();++curinnov)
+		delete (*curinnov);
+
+	innovations.clear();
+	index.clear();
+}
+
+InnovationDatabase::~InnovationDatabase() {
+	clear();
+}
@@ -16,6 +16,11 @@
 #ifndef _INNOVATION_H_
 #define _INNOVATION_H_
 
+#include <cstddef>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
 namespace NEAT {
 
 	enum innovtype {
@@ -75,6 +80,62 @@ namespace NEAT {
 
 	};
 
+	// ------------------------------------------------------------
+	// The InnovationDatabase holds the innovations of the current
+	//   generation, hashed by what identifies them:
+	//   new nodes by (in node, out node, innovnum of the split gene)
+	//   new links by (in node, out node, recur flag)
+	//   so matching a mutation against the generation is O(1) 
+	//   instead of a scan over every innovation so far.
+	//
+	//  Species may mutate concurrently: hold mutex while looking an
+	//  innovation up and adding it if it is novel, together with
+	//  taking new node ids and innovation numbers for it
+	// ------------------------------------------------------------
+	class InnovationDatabase {
+	private:
+		struct innovation_key {
+			int innovation_type;
+			int node_in_id;
+			int node_out_id;
+			double old_innov_num;
+			bool recur_flag;
+
+			bool operator==(const innovation_key &other) const;
+		};
+
+		struct innovation_key_hash {
+			std::size_t operator()(const innovation_key &key) const;
+		};
+
+		std::vector<Innovation*> innovations;  //In the order they were added
+		std::unordered_map<innovation_key,Innovation*,innovation_key_hash> index;
+
+	public:
+		std::mutex mutex;
+
+		//Return the matching innovation of this generation or 0
+		Innovation *find_node(int nin,int nout,double oldinnov) const;
+		Innovation *find_link(int nin,int nout,bool recur) const;
+
+		//Takes ownership of the innovation
+		void add(Innovation *innov);
+
+		//Delete every innovation, called when a new generation starts
+		void clear();
+
+		const std::vector<Innovation*> &get_innovations() const {
+			return innovations;
+		}
+
+		InnovationDatabase() {}
+		~InnovationDatabase();
+
+		InnovationDatabase(const InnovationDatabase&) = delete;
+		InnovationDatabase &operator=(const InnovationDatabase&) = delete;
+
+	};
+
 } // namespace NEAT
 
 #endif
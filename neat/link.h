@@ -19,6 +19,7 @@
 #include "neat.h"
 #include "trait.h"
 #include "nnode.h"
+#include "pool.h"
 
 namespace NEAT {
 
@@ -28,7 +29,7 @@ namespace NEAT {
 	// A LINK is a connection from one node to another with an associated weight 
 	// It can be marked as recurrent 
 	// Its parameters are made public for efficiency 
-	class Link {
+	class Link : public PoolAllocated<Link> {
 	public: 
 		double weight; // Weight of connection
 		NNode *in_node; // NNode inputting into the link
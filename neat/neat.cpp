@@ -18,6 +18,8 @@
 #include <fstream>
 #include <cmath>
 #include <cstring>
+#include <cstdint>
+#include <vector>
 
 double NEAT::trait_param_mut_prob = 0;
 double NEAT::trait_mutation_power = 0; // Power of mutation on a signle trait param 
@@ -434,25 +436,99 @@ double NEAT::randfloat() {
 }
 */
 
-double NEAT::gaussrand() {
-	static int iset=0;
-	static double gset;
-	double fac,rsq,v1,v2;
-
-	if (iset==0) {
-		do {
-			v1=2.0*(randfloat())-1.0;
-			v2=2.0*(randfloat())-1.0;
-			rsq=v1*v1+v2*v2;
-		} while (rsq>=1.0 || rsq==0.0);
-		fac=sqrt(-2.0*log(rsq)/rsq);
-		gset=v1*fac;
-		iset=1;
-		return v2*fac;
+// The sigmoid kernels all take the already sloped activesum
+namespace {
+	NEAT::sigmoidkernel sigmoid_kernel=NEAT::SIGMOID_EXACT;
+
+	const double sigmoid_table_range=16.0;  //sigmoid(16) is 1 within 1.2e-7
+	const int sigmoid_table_size=4096;
+
+	inline double sigmoid_exact(double x) {
+		return (1/(1+(exp(-x))));
 	}
-	else {
-		iset=0;
-		return gset;
+
+	// 1/(1+e^-x) = 0.5+0.5*tanh(x/2), with tanh from its 7th order Pade
+	// approximation. It reaches 1 at about 4.97, so clamp the argument there
+	inline double sigmoid_rational(double x) {
+		double t=0.5*x;
+		if (t>4.97) t=4.97;
+		else if (t<-4.97) t=-4.97;
+		double t2=t*t;
+		double tanh=t*(135135.0+t2*(17325.0+t2*(378.0+t2)))/(135135.0+t2*(62370.0+t2*(3150.0+t2*28.0)));
+		return 0.5+0.5*tanh;
+	}
+
+	const std::vector<double> &sigmoid_table() {
+		static const std::vector<double> table=[] {
+			std::vector<double> values(sigmoid_table_size+2);
+			for (int i=0;i<=sigmoid_table_size+1;i++)
+				values[i]=sigmoid_exact(-sigmoid_table_range+(2.0*sigmoid_table_range*i)/sigmoid_table_size);
+			return values;
+		}();
+
+		return table;
+	}
+
+	inline double sigmoid_lookup(double x) {
+		if (x<=-sigmoid_table_range) return 0.0;
+		if (x>=sigmoid_table_range) return 1.0;
+
+		const double *table=sigmoid_table().data();
+		double position=(x+sigmoid_table_range)*(sigmoid_table_size/(2.0*sigmoid_table_range));
+		int index=(int) position;
+		double fraction=position-index;
+		return table[index]+(table[index+1]-table[index])*fraction;
+	}
+
+	// Cephes style expf: exp(x) = 2^n * exp(r) with |r| <= ln2/2, written
+	// without calls or table lookups so a loop over it vectorizes
+	inline float fast_expf(float x) {
+		//Clamp |x| to 87 on the integer bits, float compares and int<->float
+		//conversions keep the compiler from vectorizing unless
+		//-fno-trapping-math is given
+		std::int32_t bits;
+		std::memcpy(&bits,&x,sizeof(bits));
+		std::int32_t magnitude=bits&0x7FFFFFFF;
+		magnitude=magnitude>0x42AE0000 ? 0x42AE0000 : magnitude;  //87.0f
+		bits=(bits&(std::int32_t) 0x80000000)|magnitude;
+		std::memcpy(&x,&bits,sizeof(x));
+
+		//Round to the nearest n by adding 1.5*2^23, which leaves n in the
+		//low mantissa bits
+		float shifted=x*1.44269504088896341f+12582912.0f;
+		float fn=shifted-12582912.0f;
+		float r=x-fn*0.693359375f+fn*2.12194440e-4f;
+
+		float p=1.9875691500e-4f;
+		p=p*r+1.3981999507e-3f;
+		p=p*r+8.3334519073e-3f;
+		p=p*r+4.1665795894e-2f;
+		p=p*r+1.6666665459e-1f;
+		p=p*r+5.0000001201e-1f;
+		p=p*r*r+r+1.0f;
+
+		std::memcpy(&bits,&shifted,sizeof(bits));
+		bits=(bits-0x4B400000+127)<<23;
+		float scale;
+		std::memcpy(&scale,&bits,sizeof(scale));
+		return p*scale;
+	}
+
+	inline double sigmoid_float(float x) {
+		return 1.0f/(1.0f+fast_expf(-x));
+	}
+
+	inline double sigmoid_with_kernel(NEAT::sigmoidkernel kernel, double x) {
+		switch (kernel) {
+		case NEAT::SIGMOID_RATIONAL:
+			return sigmoid_rational(x);
+		case NEAT::SIGMOID_TABLE:
+			return sigmoid_lookup(x);
+		case NEAT::SIGMOID_FLOAT:
+			return sigmoid_float((float) x);
+		default:
+			return sigmoid_exact(x);
+		}
 	}
 }
 
@@ -471,7 +547,83 @@ double NEAT::fsigmoid(double activesum,double slope,double constant) {
 	//return (1/(1+(exp(-activesum-constant)))); //simple left shifted
 
 	//NON-SHIFTED STEEPENED
-	return (1/(1+(exp(-(slope*activesum))))); //Compressed
+	//return (1/(1+(exp(-(slope*activesum))))); //Compressed
+	return sigmoid_with_kernel(sigmoid_kernel,slope*activesum); //Compressed, see set_sigmoid_kernel
+}
+
+void NEAT::set_sigmoid_kernel(sigmoidkernel kernel) {
+	//Build the table up front rather than on the first activation
+	if (kernel==SIGMOID_TABLE)
+		sigmoid_table();
+
+	sigmoid_kernel=kernel;
+}
+
+NEAT::sigmoidkernel NEAT::get_sigmoid_kernel() {
+	return sigmoid_kernel;
+}
+
+const char *NEAT::sigmoid_kernel_name(sigmoidkernel kernel) {
+	switch (kernel) {
+	case SIGMOID_RATIONAL:
+		return "rational";
+	case SIGMOID_TABLE:
+		return "table";
+	case SIGMOID_FLOAT:
+		return "float";
+	default:
+		return "exact";
+	}
+}
+
+bool NEAT::sigmoid_kernel_from_name(const char *name, sigmoidkernel &kernel) {
+	for (int k=SIGMOID_EXACT;k<=SIGMOID_FLOAT;k++) {
+		if (strcmp(name,sigmoid_kernel_name((sigmoidkernel) k))==0) {
+			kernel=(sigmoidkernel) k;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void NEAT::fsigmoid_array(const double *activesums, double *activations, int count, double slope) {
+	int i;
+
+	//Keep the kernel switch out of the loops so they can be vectorized
+	switch (sigmoid_kernel) {
+	case SIGMOID_RATIONAL:
+		for (i=0;i<count;i++)
+			activations[i]=sigmoid_rational(slope*activesums[i]);
+		break;
+	case SIGMOID_TABLE:
+		for (i=0;i<count;i++)
+			activations[i]=sigmoid_lookup(slope*activesums[i]);
+		break;
+	case SIGMOID_FLOAT:
+		for (i=0;i<count;i++)
+			activations[i]=sigmoid_float((float) (slope*activesums[i]));
+		break;
+	default:
+		for (i=0;i<count;i++)
+			activations[i]=sigmoid_exact(slope*activesums[i]);
+		break;
+	}
+}
+
+double NEAT::sigmoid_max_error(sigmoidkernel kernel, double slope, double range, int samples) {
+	double maxerror=0.0;
+	double activesum;
+	double error;
+
+	for (int i=0;i<samples;i++) {
+		activesum=-range+(2.0*range*i)/(samples-1);
+		error=fabs(sigmoid_with_kernel(kernel,slope*activesum)-sigmoid_exact(slope*activesum));
+		if (error>maxerror)
+			maxerror=error;
+	}
+
+	return maxerror;
 }
 
 double NEAT::oldhebbian(double weight, double maxweight, double active_in, double active_out, double hebb_rate, double pre_rate, double post_rate) {
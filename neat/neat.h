@@ -18,6 +18,7 @@
 
 #include <cstdlib>
 #include <cstring>
+#include "rng.h"
 
 namespace NEAT {
 
@@ -76,21 +77,10 @@ namespace NEAT {
 	//const char *getUnits(const char *string, int startIndex, int endIndex, const char *set);
 	int getUnitCount(const char *string, const char *set);
 
-	// Inline Random Functions 
-	extern inline int randposneg() {
-        if (rand()%2) 
-            return 1; 
-        else 
-            return -1;
-    }
-    
-	extern inline int randint(int x,int y) {
-        return rand()%(y-x+1)+x;
-    }
-
-    extern inline double randfloat() {
-        return rand() / (double) RAND_MAX;        
-    }
+	// Random Functions
+	// randposneg, randint, randfloat and gaussrand used to draw from the
+	// global rand() state, they are members of the RNG passed to the
+	// mutators now (see rng.h)
 
 
 	// SIGMOID FUNCTION ********************************
@@ -110,6 +100,34 @@ namespace NEAT {
 	// ascent as possible between -0.5 and 0.5
 	extern double fsigmoid(double,double,double);
 
+	// SIGMOID KERNELS *********************************
+	// fsigmoid and fsigmoid_array evaluate the sigmoid with the kernel
+	// selected here. SIGMOID_EXACT is the reference, the others trade
+	// precision for speed:
+	// SIGMOID_RATIONAL - 7th order Pade approximation of tanh
+	// SIGMOID_TABLE - lookup table with linear interpolation
+	// SIGMOID_FLOAT - single precision with a polynomial exp that vectorizes
+	// The kernel is global, select it before any network is activated
+	enum sigmoidkernel {
+		SIGMOID_EXACT = 0,
+		SIGMOID_RATIONAL = 1,
+		SIGMOID_TABLE = 2,
+		SIGMOID_FLOAT = 3
+	};
+
+	extern void set_sigmoid_kernel(sigmoidkernel kernel);
+	extern sigmoidkernel get_sigmoid_kernel();
+	extern const char *sigmoid_kernel_name(sigmoidkernel kernel);
+	extern bool sigmoid_kernel_from_name(const char *name, sigmoidkernel &kernel);
+
+	// Squashes count activesums at once with the selected kernel, this is
+	// where the vectorizable kernels pay off
+	extern void fsigmoid_array(const double *activesums, double *activations, int count, double slope);
+
+	// Largest absolute difference between a kernel and SIGMOID_EXACT,
+	// sampled over activesums in [-range,range] with the given slope
+	extern double sigmoid_max_error(sigmoidkernel kernel, double slope, double range = 4.0, int samples = 1000001);
+
 	// Hebbian Adaptation Function
 	// Based on equations in Floreano & Urzelai 2000
 	// Takes the current weight, the maximum weight in the containing network,
@@ -132,10 +150,6 @@ namespace NEAT {
 	//      emphasize decorrelation on hebbian learning!	
 	extern double hebbian(double weight, double maxweight, double active_in, double active_out, double hebb_rate, double pre_rate, double post_rate);
 
-	// Returns a normally distributed deviate with 0 mean and unit variance
-	// Algorithm is from Numerical Recipes in C, Second Edition
-	extern double gaussrand();
-
 	//This is an incorrect gassian distribution...but it is faster than gaussrand (maybe it's good enough?)
 	//inline double gaussrand_wrong() {return (randposneg())*(sqrt(-log((rand()*1.0)/RAND_MAX)));}   
 
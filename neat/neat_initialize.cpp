@@ -38,7 +38,7 @@ namespace NEAT
     newlink_tries = 20;
     babies_stolen = 1;
 
-    print_every = 0;
+    print_every = 10;
     num_runs = 0;
   }
 }
@@ -14,6 +14,7 @@
    limitations under the License.
 */
 #include "network.h"
+#include "profiler.h"
 #include <iostream>
 #include <sstream>
 
@@ -159,6 +160,7 @@ void Network::print_links_tofile(char *filename) {
 // Activates the net such that all outputs are active
 // Returns true on success;
 bool Network::activate() {
+	NEAT_PROFILE_HOT_SCOPE("network_activate");
 	std::vector<NNode*>::iterator curnode;
 	std::vector<Link*>::iterator curlink;
 	double add_amount;  //For adding to the activesum
@@ -375,7 +377,7 @@ void Network::add_output(NNode *out_node) {
 }
 
 // Takes an array of sensor values and loads it into SENSOR inputs ONLY
-void Network::load_sensors(double *sensvals) {
+void Network::load_sensors(const double *sensvals) {
 	//int counter=0;  //counter to move through array
 	std::vector<NNode*>::iterator sensPtr;
 
@@ -102,7 +102,7 @@ namespace NEAT {
 		void add_output(NNode*);
 
 		// Takes an array of sensor values and loads it into SENSOR inputs ONLY
-		void load_sensors(double*);
+		void load_sensors(const double*);
 		void load_sensors(const std::vector<float> &sensvals);
 
 		// Takes and array of output activations and OVERRIDES the outputs' actual 
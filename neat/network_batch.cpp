@@ -0,0 +1,176 @@
+#include "network_batch.h"
+
+#include <algorithm>
+#include <cassert>
+#include "neat.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif // __AVX2__
+
+namespace NEAT
+{
+namespace
+{
+  // sum[lane] = sum over c of weights[c][lane] * activation[source[c]][lane],
+  // accumulated in connection order like the scalar network
+  void accumulate(const std::uint32_t* sources, const double* weights, std::size_t connectionCount,
+                  const double* activation, std::size_t stride, double* sum)
+  {
+    for(std::size_t lane = 0; lane < stride; lane += NetworkBatch::LANE_WIDTH) {
+#if defined(__AVX2__)
+      auto total = _mm256_setzero_pd();
+      for(std::size_t c = 0; c < connectionCount; ++c) {
+        auto weight = _mm256_loadu_pd(weights + c * stride + lane);
+        auto input = _mm256_loadu_pd(activation + sources[c] * stride + lane);
+        total = _mm256_add_pd(total, _mm256_mul_pd(weight, input));
+      }
+      _mm256_storeu_pd(sum + lane, total);
+#elif defined(__SSE2__) || defined(_M_X64)
+      auto total = _mm_setzero_pd();
+      for(std::size_t c = 0; c < connectionCount; ++c) {
+        auto weight = _mm_loadu_pd(weights + c * stride + lane);
+        auto input = _mm_loadu_pd(activation + sources[c] * stride + lane);
+        total = _mm_add_pd(total, _mm_mul_pd(weight, input));
+      }
+      _mm_storeu_pd(sum + lane, total);
+#else
+      auto total = 0.0;
+      for(std::size_t c = 0; c < connectionCount; ++c) {
+        total += weights[c * stride + lane] * activation[sources[c] * stride + lane];
+      }
+      sum[lane] = total;
+#endif // __AVX2__
+    }
+  }
+}
+
+  NetworkBatch::NetworkBatch(const std::vector<const CompiledNetwork*>& networks) :
+    m_laneCount(networks.size()),
+    m_stride(((networks.size() + LANE_WIDTH - 1) / LANE_WIDTH) * LANE_WIDTH)
+  {
+    assert(!networks.empty());
+
+    const auto& topology = *networks.front();
+    m_sensors = topology.m_sensors;
+    m_outputs = topology.m_outputs;
+    m_neurons = topology.m_neurons;
+    m_connectionOffsets = topology.m_connectionOffsets;
+    for(const auto& connection : topology.m_connections) {
+      m_connectionSources.push_back(connection.source);
+    }
+
+    // the padding lanes keep a weight of 0
+    m_weights.assign(topology.m_connections.size() * m_stride, 0.0);
+    for(std::size_t lane = 0; lane < networks.size(); ++lane) {
+      assert(networks[lane]->hasSameTopology(topology));
+
+      const auto& connections = networks[lane]->m_connections;
+      for(std::size_t c = 0; c < connections.size(); ++c) {
+        m_weights[c * m_stride + lane] = connections[c].weight;
+      }
+    }
+
+    const auto nodeCount = topology.getNodeCount();
+    m_activation.resize(nodeCount * m_stride);
+    m_activesum.resize(m_neurons.size() * m_stride);
+    m_activated.resize(nodeCount);
+    m_activeFlag.resize(nodeCount);
+    flush();
+  }
+
+  void NetworkBatch::loadSensors(std::size_t lane, const double* values)
+  {
+    for(auto sensor : m_sensors) {
+      m_activation[sensor * m_stride + lane] = *values++;
+      m_activated[sensor] = 1;
+    }
+  }
+
+  bool NetworkBatch::activate()
+  {
+    auto onetime = false;
+    auto abortcount = 0;
+    while(outputsOff() || !onetime) {
+      if(++abortcount == 20) {
+        return false;
+      }
+
+      const auto neuronCount = m_neurons.size();
+      for(std::size_t i = 0; i < neuronCount; ++i) {
+        auto begin = m_connectionOffsets[i];
+        auto count = m_connectionOffsets[i + 1] - begin;
+
+        unsigned char active = 0;
+        for(std::size_t c = begin; c < begin + count; ++c) {
+          active |= m_activeFlag[m_connectionSources[c]];
+        }
+
+        accumulate(m_connectionSources.data() + begin, m_weights.data() + begin * m_stride, count,
+                   m_activation.data(), m_stride, m_activesum.data() + i * m_stride);
+        m_activeFlag[m_neurons[i]] = active;
+      }
+
+      for(std::size_t i = 0; i < neuronCount; ++i) {
+        auto node = m_neurons[i];
+        if(m_activeFlag[node]) {
+          auto* activation = m_activation.data() + node * m_stride;
+          const auto* activesum = m_activesum.data() + i * m_stride;
+          fsigmoid_array(activesum, activation, static_cast<int>(m_laneCount), 4.924273);
+          m_activated[node] = 1;
+        }
+      }
+
+      onetime = true;
+    }
+
+    return true;
+  }
+
+  void NetworkBatch::flush()
+  {
+    std::fill(m_activation.begin(), m_activation.end(), 0.0);
+    std::fill(m_activesum.begin(), m_activesum.end(), 0.0);
+    std::fill(m_activated.begin(), m_activated.end(), 0);
+
+    std::fill(m_activeFlag.begin(), m_activeFlag.end(), 1);
+    for(auto neuron : m_neurons) {
+      m_activeFlag[neuron] = 0;
+    }
+  }
+
+  void NetworkBatch::retainLanes(const std::vector<std::size_t>& lanes)
+  {
+    auto stride = ((lanes.size() + LANE_WIDTH - 1) / LANE_WIDTH) * LANE_WIDTH;
+    auto compact = [this, &lanes, stride](const std::vector<double>& values) {
+      auto rows = m_stride > 0 ? values.size() / m_stride : 0;
+      std::vector<double> compacted(rows * stride, 0.0);
+      for(std::size_t row = 0; row < rows; ++row) {
+        for(std::size_t lane = 0; lane < lanes.size(); ++lane) {
+          compacted[row * stride + lane] = values[row * m_stride + lanes[lane]];
+        }
+      }
+      return compacted;
+    };
+
+    m_weights = compact(m_weights);
+    m_activation = compact(m_activation);
+    m_activesum = compact(m_activesum);
+
+    m_laneCount = lanes.size();
+    m_stride = stride;
+  }
+
+  bool NetworkBatch::outputsOff() const
+  {
+    for(auto output : m_outputs) {
+      if(!m_activated[output]) {
+        return true;
+      }
+    }
+
+    return false;
+  }
+}
@@ -0,0 +1,69 @@
+#ifndef NETWORK_BATCH_H
+#define NETWORK_BATCH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "compiled_network.h"
+
+namespace NEAT
+{
+  // Activates many networks that share a topology at once. The weights and
+  // node states are stored as structure of arrays, one lane per network,
+  // so the incoming sums of a neuron are computed for a whole block of
+  // networks with one SIMD instruction per connection (4 lanes with AVX2,
+  // 2 with SSE2, otherwise scalar).
+  //
+  // All lanes are activated together, so the control flow of the
+  // activation (active flags, passes until the outputs fire) is shared and
+  // every lane computes exactly what its CompiledNetwork would
+  class NetworkBatch
+  {
+  public:
+#if defined(__AVX2__)
+    static constexpr std::size_t LANE_WIDTH = 4;
+#elif defined(__SSE2__) || defined(_M_X64)
+    static constexpr std::size_t LANE_WIDTH = 2;
+#else
+    static constexpr std::size_t LANE_WIDTH = 1;
+#endif // __AVX2__
+
+    // Every network must have the same topology as the first one
+    explicit NetworkBatch(const std::vector<const CompiledNetwork*>& networks);
+
+    void loadSensors(std::size_t lane, const double* values);
+    bool activate();
+    void flush();
+
+    // Keeps only the given lanes, in the given order, with their current
+    // state. Used to drop the networks that are no longer needed
+    void retainLanes(const std::vector<std::size_t>& lanes);
+
+    std::size_t getLaneCount() const { return m_laneCount; }
+    double getOutput(std::size_t lane, std::size_t index) const { return m_activation[m_outputs[index] * m_stride + lane]; }
+
+  private:
+    bool outputsOff() const;
+
+    std::size_t                                 m_laneCount;
+    // lanes rounded up to the SIMD width
+    std::size_t                                 m_stride;
+
+    std::vector<std::uint32_t>                  m_sensors;
+    std::vector<std::uint32_t>                  m_outputs;
+    std::vector<std::uint32_t>                  m_neurons;
+    std::vector<std::uint32_t>                  m_connectionOffsets;
+    std::vector<std::uint32_t>                  m_connectionSources;
+
+    // [connection][lane], [node][lane] and [neuron][lane]
+    std::vector<double>                         m_weights;
+    std::vector<double>                         m_activation;
+    std::vector<double>                         m_activesum;
+
+    // shared by all the lanes
+    std::vector<unsigned char>                  m_activated;
+    std::vector<unsigned char>                  m_activeFlag;
+  };
+}
+
+#endif // NETWORK_BATCH_H
@@ -21,6 +21,7 @@
 #include "neat.h"
 #include "trait.h"
 #include "link.h"
+#include "pool.h"
 
 namespace NEAT {
 
@@ -49,10 +50,12 @@ namespace NEAT {
 	//   - If it's a sensor, it can be loaded with a value for output
 	//   - If it's a neuron, it has a list of its incoming input signals (List<Link> is used) 
 	// Use an activation count to avoid flushing
-	class NNode {
+	class NNode : public PoolAllocated<NNode> {
 
 		friend class Network;
 		friend class Genome;
+		friend class Checkpoint;
+		friend class PackedGenome;
 
 	protected:
 
@@ -21,7 +21,7 @@ Organism::Organism(double fit, Genome *g,int gen, const char* md) {
 	fitness=fit;
 	orig_fitness=fitness;
 	gnome=g;
-	net=gnome->genesis(gnome->genome_id);
+	net=0;  //Generated on demand, most organisms never need it
 	species=0;  //Start it in no Species
 	expected_offspring=0;
 	generation=gen;
@@ -56,7 +56,7 @@ Organism::Organism(const Organism& org)
 	orig_fitness = org.orig_fitness;
 	gnome = new Genome(*(org.gnome));	// Associative relationship
 	//gnome = org.gnome->duplicate(org.gnome->genome_id);
-	net = new Network(*(org.net)); // Associative relationship
+	net = org.net ? new Network(*(org.net)) : 0; // Associative relationship
 	species = org.species;	// Delegation relationship
 	expected_offspring = org.expected_offspring;
 	generation = org.generation;
@@ -89,12 +89,18 @@ void Organism::update_phenotype() {
 	//First, delete the old phenotype (net)
 	delete net;
 
-	//Now, recreate the phenotype off the new genotype
-	net=gnome->genesis(gnome->genome_id);
+	//The phenotype is recreated off the new genotype when next needed
+	net=0;
 
 	modified = true;
 }
 
+Network *Organism::get_net() {
+	if (net==0)
+		net=gnome->genesis(gnome->genome_id);
+	return net;
+}
+
 bool Organism::print_to_file(char *filename) {
 	
 	std::ofstream oFile(filename);
@@ -37,7 +37,7 @@ namespace NEAT {
 		double orig_fitness;  //A fitness measure that won't change during adjustments
 		double error;  //Used just for reporting purposes
 		bool winner;  //Win marker (if needed for a particular task)
-		Network *net;  //The Organism's phenotype
+		Network *net;  //The Organism's phenotype, built by get_net the first time it is needed
 		Genome *gnome; //The Organism's genotype 
 		Species *species;  //The Organism's Species 
 		double expected_offspring; //Number of children this Organism may have
@@ -58,6 +58,9 @@ namespace NEAT {
 		char metadata[128];
 		bool modified;
 
+		// The phenotype, generated off the genotype on the first call
+		Network *get_net();
+
 		// Regenerate the network based on a change in the genotype 
 		void update_phenotype();
 
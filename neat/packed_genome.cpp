@@ -0,0 +1,410 @@
+#include "packed_genome.h"
+
+#include <algorithm>
+#include <numeric>
+#include <unordered_set>
+
+namespace NEAT
+{
+  namespace
+  {
+    std::uint64_t linkKey(int in, int out)
+    {
+      return (static_cast<std::uint64_t>(static_cast<std::uint32_t>(in)) << 32) | static_cast<std::uint32_t>(out);
+    }
+
+    template<class T>
+    std::size_t capacityBytes(const std::vector<T>& values)
+    {
+      return values.capacity() * sizeof(T);
+    }
+
+    template<class Pointer>
+    int indexOf(const std::vector<Pointer>& values, const void* value)
+    {
+      auto it = std::find(values.begin(), values.end(), value);
+      return it != values.end() ? static_cast<int>(it - values.begin()) : PackedGenome::NO_TRAIT;
+    }
+  }
+
+  PackedGenome::PackedGenome(const Genome& genome) :
+    m_id(genome.genome_id)
+  {
+    reserve(genome.traits.size(), genome.nodes.size(), genome.genes.size());
+
+    for(const auto* trait : genome.traits) {
+      m_traitIds.push_back(trait->trait_id);
+      m_traitParams.insert(m_traitParams.end(), trait->params, trait->params + num_trait_params);
+    }
+
+    // Genome keeps both lists ordered already, except for hand written files
+    std::vector<std::size_t> order(genome.nodes.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b) {
+      return genome.nodes[a]->node_id < genome.nodes[b]->node_id;
+    });
+    for(auto i : order) {
+      const auto* node = genome.nodes[i];
+      m_nodeIds.push_back(node->node_id);
+      m_nodeTypes.push_back(static_cast<std::uint8_t>(node->type));
+      m_nodeLabels.push_back(static_cast<std::uint8_t>(node->gen_node_label));
+      m_nodeTraits.push_back(indexOf(genome.traits, node->nodetrait));
+    }
+
+    order.resize(genome.genes.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b) {
+      return genome.genes[a]->innovation_num < genome.genes[b]->innovation_num;
+    });
+    for(auto i : order) {
+      const auto* gene = genome.genes[i];
+      const auto* link = gene->lnk;
+      m_innovations.push_back(gene->innovation_num);
+      m_mutations.push_back(gene->mutation_num);
+      m_weights.push_back(link->weight);
+      m_inNodes.push_back(link->in_node->node_id);
+      m_outNodes.push_back(link->out_node->node_id);
+      m_geneTraits.push_back(indexOf(genome.traits, link->linktrait));
+      m_geneFlags.push_back(static_cast<std::uint8_t>((gene->enable ? GENE_ENABLED : 0) |
+                                                      (link->is_recurrent ? GENE_RECURRENT : 0) |
+                                                      (gene->frozen ? GENE_FROZEN : 0) |
+                                                      (link->time_delay ? GENE_TIME_DELAY : 0)));
+    }
+  }
+
+  Genome* PackedGenome::toGenome() const
+  {
+    std::vector<Trait*> traits;
+    traits.reserve(m_traitIds.size());
+    for(std::size_t i = 0; i < m_traitIds.size(); ++i) {
+      auto* trait = new Trait();
+      trait->trait_id = m_traitIds[i];
+      std::copy_n(m_traitParams.begin() + i * num_trait_params, num_trait_params, trait->params);
+      traits.push_back(trait);
+    }
+
+    auto findTrait = [&](int index) -> Trait* {
+      return index >= 0 && static_cast<std::size_t>(index) < traits.size() ? traits[index] : nullptr;
+    };
+
+    std::vector<NNode*> nodes;
+    nodes.reserve(m_nodeIds.size());
+    for(std::size_t i = 0; i < m_nodeIds.size(); ++i) {
+      auto* node = new NNode(static_cast<nodetype>(m_nodeTypes[i]), m_nodeIds[i], static_cast<nodeplace>(m_nodeLabels[i]));
+      node->nodetrait = findTrait(m_nodeTraits[i]);
+      node->trait_id = node->nodetrait ? node->nodetrait->trait_id : 1;
+      nodes.push_back(node);
+    }
+
+    std::vector<Gene*> genes;
+    genes.reserve(m_innovations.size());
+    for(std::size_t i = 0; i < m_innovations.size(); ++i) {
+      auto flags = m_geneFlags[i];
+      auto* gene = new Gene(findTrait(m_geneTraits[i]), m_weights[i], nodes[findNode(m_inNodes[i])],
+                            nodes[findNode(m_outNodes[i])], (flags & GENE_RECURRENT) != 0, m_innovations[i],
+                            m_mutations[i]);
+      gene->lnk->time_delay = (flags & GENE_TIME_DELAY) != 0;
+      gene->enable = (flags & GENE_ENABLED) != 0;
+      gene->frozen = (flags & GENE_FROZEN) != 0;
+      genes.push_back(gene);
+    }
+
+    return new Genome(m_id, traits, nodes, genes);
+  }
+
+  double PackedGenome::compatibility(const PackedGenome& other) const
+  {
+    double numDisjoint = 0.0;
+    double numExcess = 0.0;
+    double mutDiffTotal = 0.0;
+    double numMatching = 0.0;
+
+    const auto size1 = m_innovations.size();
+    const auto size2 = other.m_innovations.size();
+    std::size_t p1 = 0;
+    std::size_t p2 = 0;
+    while(p1 < size1 && p2 < size2) {
+      auto innovation1 = m_innovations[p1];
+      auto innovation2 = other.m_innovations[p2];
+      if(innovation1 == innovation2) {
+        numMatching += 1.0;
+        auto mutDiff = m_mutations[p1] - other.m_mutations[p2];
+        if(mutDiff < 0.0) {
+          mutDiff = 0.0 - mutDiff;
+        }
+        mutDiffTotal += mutDiff;
+
+        ++p1;
+        ++p2;
+      } else {
+        if(innovation1 < innovation2) {
+          ++p1;
+        } else {
+          ++p2;
+        }
+        numDisjoint += 1.0;
+      }
+    }
+    numExcess += static_cast<double>((size1 - p1) + (size2 - p2));
+
+    return disjoint_coeff * (numDisjoint / 1.0) +
+           excess_coeff * (numExcess / 1.0) +
+           mutdiff_coeff * (mutDiffTotal / numMatching);
+  }
+
+  void PackedGenome::mutateLinkWeights(double power, double rate, mutator mutType, RNG& rng)
+  {
+    // once in a while really shake things up
+    const bool severe = rng.randfloat() > 0.5;
+
+    // the tail of the genome holds the least tested genes and gets more
+    // cold gaussian mutations
+    const auto geneTotal = static_cast<double>(m_weights.size());
+    const auto endPart = geneTotal * 0.8;
+    double num = 0.0;
+
+    for(std::size_t i = 0; i < m_weights.size(); ++i) {
+      if(m_geneFlags[i] & GENE_FROZEN) {
+        continue;
+      }
+
+      double gaussPoint;
+      double coldGaussPoint;
+      if(severe) {
+        gaussPoint = 0.3;
+        coldGaussPoint = 0.1;
+      } else if(geneTotal >= 10.0 && num > endPart) {
+        gaussPoint = 0.5;
+        coldGaussPoint = 0.3;
+      } else if(rng.randfloat() > 0.5) {
+        gaussPoint = 1.0 - rate;
+        coldGaussPoint = 1.0 - rate - 0.1;
+      } else {
+        gaussPoint = 1.0 - rate;
+        coldGaussPoint = 1.0 - rate;
+      }
+
+      auto randNum = rng.randposneg() * rng.randfloat() * power * 1.0;
+      auto& weight = m_weights[i];
+      if(mutType == GAUSSIAN) {
+        auto randChoice = rng.randfloat();
+        if(randChoice > gaussPoint) {
+          weight += randNum;
+        } else if(randChoice > coldGaussPoint) {
+          weight = randNum;
+        }
+      } else if(mutType == COLDGAUSSIAN) {
+        weight = randNum;
+      }
+
+      if(weight > 8.0) {
+        weight = 8.0;
+      } else if(weight < -8.0) {
+        weight = -8.0;
+      }
+
+      m_mutations[i] = weight;
+      num += 1.0;
+    }
+  }
+
+  void PackedGenome::mutateToggleEnable(int times, RNG& rng)
+  {
+    const auto geneCount = m_innovations.size();
+    for(int count = 0; count < times; ++count) {
+      auto gene = static_cast<std::size_t>(rng.randint(0, static_cast<int>(geneCount) - 1));
+
+      if(!(m_geneFlags[gene] & GENE_ENABLED)) {
+        m_geneFlags[gene] |= GENE_ENABLED;
+        continue;
+      }
+
+      // only disable it when another enabled gene leaves its in node, so
+      // that no part of the network breaks off
+      for(std::size_t other = 0; other < geneCount; ++other) {
+        if(m_inNodes[other] == m_inNodes[gene] && (m_geneFlags[other] & GENE_ENABLED) &&
+           m_innovations[other] != m_innovations[gene]) {
+          m_geneFlags[gene] &= static_cast<std::uint8_t>(~GENE_ENABLED);
+          break;
+        }
+      }
+    }
+  }
+
+  PackedGenome PackedGenome::mateMultipoint(const PackedGenome& mom, const PackedGenome& dad, int id,
+                                            double momFitness, double dadFitness, RNG& rng)
+  {
+    PackedGenome baby;
+    baby.m_id = id;
+    baby.reserve(mom.m_traitIds.size(), std::max(mom.m_nodeIds.size(), dad.m_nodeIds.size()),
+                 mom.m_innovations.size() + dad.m_innovations.size());
+
+    // the traits are averaged, both parents are assumed to have as many
+    baby.m_traitIds = mom.m_traitIds;
+    baby.m_traitParams.resize(mom.m_traitParams.size());
+    for(std::size_t i = 0; i < mom.m_traitParams.size(); ++i) {
+      baby.m_traitParams[i] = (mom.m_traitParams[i] + dad.m_traitParams[i]) / 2.0;
+    }
+
+    // the worse parent brings no structural baggage, on a tie the smaller does
+    bool momBetter;
+    if(momFitness > dadFitness) {
+      momBetter = true;
+    } else if(momFitness == dadFitness) {
+      momBetter = mom.m_innovations.size() < dad.m_innovations.size();
+    } else {
+      momBetter = false;
+    }
+
+    // a node is copied from the first parent it is taken from. The ids
+    // are sorted once at the end instead of inserting each node in order
+    struct NodeSource
+    {
+      int                   id;
+      const PackedGenome*   genome;
+      std::size_t           index;
+    };
+    std::vector<NodeSource> nodes;
+    std::unordered_set<int> nodeIds;
+    auto addNode = [&](const PackedGenome& genome, int nodeId) {
+      if(nodeIds.insert(nodeId).second) {
+        nodes.push_back({ nodeId, &genome, genome.findNode(nodeId) });
+      }
+    };
+
+    // every sensor and output of dad is included
+    for(std::size_t i = 0; i < dad.m_nodeIds.size(); ++i) {
+      auto label = dad.m_nodeLabels[i];
+      if(label == INPUT || label == BIAS || label == OUTPUT) {
+        addNode(dad, dad.m_nodeIds[i]);
+      }
+    }
+
+    // links taken so far, recurrent and not, to refuse a gene that
+    // duplicates one, or reverses a non recurrent one
+    std::unordered_set<std::uint64_t> links[2];
+    bool disable = false;
+
+    const auto momSize = mom.m_innovations.size();
+    const auto dadSize = dad.m_innovations.size();
+    std::size_t p1 = 0;
+    std::size_t p2 = 0;
+    while(p1 < momSize || p2 < dadSize) {
+      const PackedGenome* parent;
+      std::size_t gene;
+      bool skip = false;
+
+      if(p1 == momSize) {
+        parent = &dad;
+        gene = p2++;
+        skip = momBetter;
+      } else if(p2 == dadSize) {
+        parent = &mom;
+        gene = p1++;
+        skip = !momBetter;
+      } else if(mom.m_innovations[p1] == dad.m_innovations[p2]) {
+        if(rng.randfloat() < 0.5) {
+          parent = &mom;
+          gene = p1;
+        } else {
+          parent = &dad;
+          gene = p2;
+        }
+
+        // a gene disabled in either parent is likely disabled in the baby
+        if((!(mom.m_geneFlags[p1] & GENE_ENABLED) || !(dad.m_geneFlags[p2] & GENE_ENABLED)) &&
+           rng.randfloat() < 0.75) {
+          disable = true;
+        }
+
+        ++p1;
+        ++p2;
+      } else if(mom.m_innovations[p1] < dad.m_innovations[p2]) {
+        parent = &mom;
+        gene = p1++;
+        skip = !momBetter;
+      } else {
+        parent = &dad;
+        gene = p2++;
+        skip = momBetter;
+      }
+
+      auto in = parent->m_inNodes[gene];
+      auto out = parent->m_outNodes[gene];
+      auto flags = parent->m_geneFlags[gene];
+      bool recurrent = (flags & GENE_RECURRENT) != 0;
+      if(links[recurrent].count(linkKey(in, out)) || (!recurrent && links[0].count(linkKey(out, in)))) {
+        skip = true;
+      }
+      if(skip) {
+        continue;
+      }
+
+      links[recurrent].insert(linkKey(in, out));
+      addNode(*parent, in);
+      addNode(*parent, out);
+
+      // a copied link loses its time delay like in Gene(Gene*, ...)
+      flags &= static_cast<std::uint8_t>(~GENE_TIME_DELAY);
+      if(disable) {
+        flags &= static_cast<std::uint8_t>(~GENE_ENABLED);
+        disable = false;
+      }
+
+      baby.m_innovations.push_back(parent->m_innovations[gene]);
+      baby.m_mutations.push_back(parent->m_mutations[gene]);
+      baby.m_weights.push_back(parent->m_weights[gene]);
+      baby.m_inNodes.push_back(in);
+      baby.m_outNodes.push_back(out);
+      baby.m_geneTraits.push_back(parent->m_geneTraits[gene]);
+      baby.m_geneFlags.push_back(flags);
+    }
+
+    std::sort(nodes.begin(), nodes.end(), [](const NodeSource& a, const NodeSource& b) { return a.id < b.id; });
+    for(const auto& node : nodes) {
+      // a copied node without a trait gets the first one like in NNode(NNode*, Trait*)
+      auto trait = node.genome->m_nodeTraits[node.index];
+      baby.m_nodeIds.push_back(node.id);
+      baby.m_nodeTypes.push_back(node.genome->m_nodeTypes[node.index]);
+      baby.m_nodeLabels.push_back(node.genome->m_nodeLabels[node.index]);
+      baby.m_nodeTraits.push_back(trait == NO_TRAIT ? 0 : trait);
+    }
+
+    return baby;
+  }
+
+  std::size_t PackedGenome::getMemoryUsage() const
+  {
+    return sizeof(PackedGenome) +
+           capacityBytes(m_traitIds) + capacityBytes(m_traitParams) +
+           capacityBytes(m_nodeIds) + capacityBytes(m_nodeTypes) + capacityBytes(m_nodeLabels) +
+           capacityBytes(m_nodeTraits) +
+           capacityBytes(m_innovations) + capacityBytes(m_mutations) + capacityBytes(m_weights) +
+           capacityBytes(m_inNodes) + capacityBytes(m_outNodes) + capacityBytes(m_geneTraits) +
+           capacityBytes(m_geneFlags);
+  }
+
+  void PackedGenome::reserve(std::size_t traits, std::size_t nodes, std::size_t genes)
+  {
+    m_traitIds.reserve(traits);
+    m_traitParams.reserve(traits * num_trait_params);
+
+    m_nodeIds.reserve(nodes);
+    m_nodeTypes.reserve(nodes);
+    m_nodeLabels.reserve(nodes);
+    m_nodeTraits.reserve(nodes);
+
+    m_innovations.reserve(genes);
+    m_mutations.reserve(genes);
+    m_weights.reserve(genes);
+    m_inNodes.reserve(genes);
+    m_outNodes.reserve(genes);
+    m_geneTraits.reserve(genes);
+    m_geneFlags.reserve(genes);
+  }
+
+  std::size_t PackedGenome::findNode(int id) const
+  {
+    return static_cast<std::size_t>(std::lower_bound(m_nodeIds.begin(), m_nodeIds.end(), id) - m_nodeIds.begin());
+  }
+}
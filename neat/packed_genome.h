@@ -0,0 +1,87 @@
+#ifndef PACKED_GENOME_H
+#define PACKED_GENOME_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "genome.h"
+
+namespace NEAT
+{
+  // A Genome as plain arrays: every trait, node and gene field in its own
+  // vector, nodes sorted by id and genes sorted by innovation number. Nodes
+  // and genes refer to traits by position and genes to nodes by id, so a
+  // packed genome holds no pointers and copies like a value. Compatibility,
+  // weight mutation and multipoint crossover are linear scans over the
+  // arrays. They draw the same random numbers in the same order as their
+  // Genome counterparts and give the same genomes
+  class PackedGenome
+  {
+  public:
+    enum GeneFlags : std::uint8_t
+    {
+      GENE_ENABLED = 1 << 0,
+      GENE_RECURRENT = 1 << 1,
+      GENE_FROZEN = 1 << 2,
+      GENE_TIME_DELAY = 1 << 3
+    };
+
+    static constexpr int NO_TRAIT = -1;
+
+    explicit PackedGenome(const Genome& genome);
+
+    // A new Genome with the same traits, nodes and genes
+    Genome* toGenome() const;
+
+    // Genome::compatibility
+    double compatibility(const PackedGenome& other) const;
+
+    // Genome::mutate_link_weights and Genome::mutate_toggle_enable
+    void mutateLinkWeights(double power, double rate, mutator mutType, RNG& rng);
+    void mutateToggleEnable(int times, RNG& rng);
+
+    // Genome::mate_multipoint with mom as this and dad as g. The conflict
+    // and node existence checks are hash lookups instead of list scans
+    static PackedGenome mateMultipoint(const PackedGenome& mom, const PackedGenome& dad, int id,
+                                       double momFitness, double dadFitness, RNG& rng);
+
+    int getId() const { return m_id; }
+    std::size_t getTraitCount() const { return m_traitIds.size(); }
+    std::size_t getNodeCount() const { return m_nodeIds.size(); }
+    std::size_t getGeneCount() const { return m_innovations.size(); }
+
+    double getWeight(std::size_t gene) const { return m_weights[gene]; }
+    double getInnovation(std::size_t gene) const { return m_innovations[gene]; }
+    bool isEnabled(std::size_t gene) const { return (m_geneFlags[gene] & GENE_ENABLED) != 0; }
+
+    // bytes held by the arrays, the object itself included
+    std::size_t getMemoryUsage() const;
+
+  private:
+    PackedGenome() = default;
+
+    void reserve(std::size_t traits, std::size_t nodes, std::size_t genes);
+    std::size_t findNode(int id) const;
+
+    int                         m_id = 0;
+
+    // one row of num_trait_params per trait
+    std::vector<int>            m_traitIds;
+    std::vector<double>         m_traitParams;
+
+    std::vector<int>            m_nodeIds;
+    std::vector<std::uint8_t>   m_nodeTypes;
+    std::vector<std::uint8_t>   m_nodeLabels;
+    std::vector<int>            m_nodeTraits;
+
+    std::vector<double>         m_innovations;
+    std::vector<double>         m_mutations;
+    std::vector<double>         m_weights;
+    std::vector<int>            m_inNodes;
+    std::vector<int>            m_outNodes;
+    std::vector<int>            m_geneTraits;
+    std::vector<std::uint8_t>   m_geneFlags;
+  };
+}
+
+#endif // PACKED_GENOME_H
@@ -0,0 +1,210 @@
+#ifndef POOL_H
+#define POOL_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <new>
+#include <vector>
+
+namespace NEAT
+{
+  struct PoolCounters
+  {
+    std::uint64_t allocations;    // objects handed out
+    std::uint64_t deallocations;  // objects given back
+    std::uint64_t slabs;          // calls to the system allocator
+    std::uint64_t bytesReserved;  // memory held by the slabs
+  };
+
+  // Fixed size allocator for one genome component type. Memory is carved
+  // out of slabs of OBJECTS_PER_SLAB objects, which are never given back
+  // to the system: a generation reuses the slots the previous one freed,
+  // so after the first few epochs reproduction no longer touches the heap.
+  // Every thread allocates from its own free list and its own slab, so the
+  // genes a thread copies for one genome end up next to each other. A
+  // thread keeps at most 2 * FREE_BATCH free slots: once it has that many,
+  // like the one deleting the babies the workers made, the FREE_BATCH it
+  // freed first go to a shared list and the newer ones stay for its next
+  // allocations. A thread that runs out takes a batch from the shared list
+  // before it asks for a new slab. The slots of an exiting thread move to
+  // the shared list as well, in batches of at most FREE_BATCH
+  template<class T>
+  class Pool
+  {
+  public:
+    static constexpr std::size_t OBJECTS_PER_SLAB = 1024;
+    static constexpr std::size_t FREE_BATCH = OBJECTS_PER_SLAB;
+
+    static void* allocate()
+    {
+      auto& cache = t_cache;
+      s_allocations.fetch_add(1, std::memory_order_relaxed);
+
+      while(true) {
+        if(auto* slot = cache.freeList) {
+          cache.freeList = slot->next;
+          --cache.freeCount;
+          return slot;
+        }
+        if(cache.bump != cache.bumpEnd || refill(cache)) {
+          return cache.bump++;
+        }
+      }
+    }
+
+    static void deallocate(void* pointer)
+    {
+      if(!pointer) {
+        return;
+      }
+
+      auto& cache = t_cache;
+      s_deallocations.fetch_add(1, std::memory_order_relaxed);
+
+      auto* slot = static_cast<Slot*>(pointer);
+      slot->next = cache.freeList;
+      cache.freeList = slot;
+
+      // the slot on top of the oldest FREE_BATCH ones, cutting there
+      // shares them and keeps the newer batch for this thread
+      ++cache.freeCount;
+      if(cache.freeCount == FREE_BATCH + 1) {
+        cache.batchTop = slot;
+      } else if(cache.freeCount == 2 * FREE_BATCH) {
+        auto* batch = cache.batchTop->next;
+        cache.batchTop->next = nullptr;
+        cache.freeCount = FREE_BATCH;
+        share(batch, FREE_BATCH);
+      }
+    }
+
+    static PoolCounters getCounters()
+    {
+      auto slabs = s_slabs.load(std::memory_order_relaxed);
+      return { s_allocations.load(std::memory_order_relaxed),
+               s_deallocations.load(std::memory_order_relaxed),
+               slabs,
+               slabs * OBJECTS_PER_SLAB * sizeof(Slot) };
+    }
+
+  private:
+    union Slot
+    {
+      Slot*                               next;
+      alignas(T) unsigned char            storage[sizeof(T)];
+    };
+
+    struct Cache
+    {
+      Slot*         freeList = nullptr;
+      std::size_t   freeCount = 0;
+
+      // only valid while freeCount > FREE_BATCH, a refill never brings
+      // more than FREE_BATCH slots so freeCount only gets there by frees
+      Slot*         batchTop = nullptr;
+      Slot*         bump = nullptr;
+      Slot*         bumpEnd = nullptr;
+
+      ~Cache()
+      {
+        // whatever is left in the current slab goes back with the free slots
+        while(bump != bumpEnd) {
+          auto* slot = bump++;
+          slot->next = freeList;
+          freeList = slot;
+          ++freeCount;
+        }
+
+        while(freeList) {
+          auto* first = freeList;
+          std::size_t count = 1;
+          while(count < FREE_BATCH && freeList->next) {
+            freeList = freeList->next;
+            ++count;
+          }
+
+          auto* rest = freeList->next;
+          freeList->next = nullptr;
+          share(first, count);
+          freeList = rest;
+        }
+      }
+    };
+
+    struct Batch
+    {
+      Slot*         first;
+      std::size_t   count;
+    };
+
+    static void share(Slot* first, std::size_t count)
+    {
+      std::lock_guard<std::mutex> lock(s_mutex);
+      s_shared.push_back({ first, count });
+    }
+
+    // Takes a batch of shared slots or a new slab. Returns false when a
+    // batch was moved to the free list, true when bump was set up
+    static bool refill(Cache& cache)
+    {
+      {
+        std::lock_guard<std::mutex> lock(s_mutex);
+        if(!s_shared.empty()) {
+          cache.freeList = s_shared.back().first;
+          cache.freeCount = s_shared.back().count;
+          s_shared.pop_back();
+          return false;
+        }
+      }
+
+      // slabs live until the program ends, objects are destroyed by then
+      auto* slab = static_cast<Slot*>(::operator new(OBJECTS_PER_SLAB * sizeof(Slot)));
+      s_slabs.fetch_add(1, std::memory_order_relaxed);
+
+      cache.bump = slab;
+      cache.bumpEnd = slab + OBJECTS_PER_SLAB;
+      return true;
+    }
+
+    static thread_local Cache           t_cache;
+
+    static std::mutex                   s_mutex;
+    static std::vector<Batch>           s_shared;
+
+    static std::atomic<std::uint64_t>   s_allocations;
+    static std::atomic<std::uint64_t>   s_deallocations;
+    static std::atomic<std::uint64_t>   s_slabs;
+  };
+
+  template<class T> thread_local typename Pool<T>::Cache  Pool<T>::t_cache;
+  template<class T> std::mutex                            Pool<T>::s_mutex;
+  template<class T> std::vector<typename Pool<T>::Batch>  Pool<T>::s_shared;
+  template<class T> std::atomic<std::uint64_t>            Pool<T>::s_allocations(0);
+  template<class T> std::atomic<std::uint64_t>            Pool<T>::s_deallocations(0);
+  template<class T> std::atomic<std::uint64_t>            Pool<T>::s_slabs(0);
+
+  // Base of the classes that allocate from Pool<T>. Derived classes of a
+  // different size fall back to the global operator new
+  template<class T>
+  class PoolAllocated
+  {
+  public:
+    static void* operator new(std::size_t size)
+    {
+      return size == sizeof(T) ? Pool<T>::allocate() : ::operator new(size);
+    }
+
+    static void operator delete(void* pointer, std::size_t size)
+    {
+      if(size == sizeof(T)) {
+        Pool<T>::deallocate(pointer);
+      } else {
+        ::operator delete(pointer);
+      }
+    }
+  };
+}
+
+#endif // POOL_H
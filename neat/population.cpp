@@ -17,19 +17,25 @@
 #include "debug.h"
 #include "population.h"
 #include "organism.h"
+#include "profiler.h"
+#include "reproduction.h"
 #include <iostream>
 #include <sstream>
 #include <fstream>
 using namespace NEAT;
 
-Population::Population(Genome *g,int size) {
+Population::Population() : cur_node_id(0), cur_innov_num(0.0), last_species(0), rng(0), thread_pool(0), deterministic_reproduction(true),
+	mean_fitness(0.0), variance(0.0), standard_deviation(0.0), winnergen(0), highest_fitness(0.0), highest_last_changed(0) {
+}
+
+Population::Population(Genome *g,int size,std::uint64_t seed) : rng(seed), thread_pool(0), deterministic_reproduction(true) {
 	winnergen=0;
 	highest_fitness=0.0;
 	highest_last_changed=0;
 	spawn(g,size);
 }
 
-Population::Population(Genome *g,int size, float power) {
+Population::Population(Genome *g,int size, float power,std::uint64_t seed) : rng(seed), thread_pool(0), deterministic_reproduction(true) {
 	winnergen=0;
 	highest_fitness=0.0;
 	highest_last_changed=0;
@@ -63,7 +69,7 @@ Population::Population(Genome *g,int size, float power) {
 //MSC Addition
 //Added the ability for a population to be spawned
 //off of a vector of Genomes.  Useful when converging.
-Population::Population(std::vector<Genome*> genomeList, float power) {
+Population::Population(std::vector<Genome*> genomeList, float power,std::uint64_t seed) : rng(seed), thread_pool(0), deterministic_reproduction(true) {
 	
 	winnergen=0;
 	highest_fitness=0.0;
@@ -80,9 +86,9 @@ Population::Population(std::vector<Genome*> genomeList, float power) {
 
 		new_genome=(*iter); 
 		if(power>0)
-			new_genome->mutate_link_weights(power,1.0,GAUSSIAN);
+			new_genome->mutate_link_weights(power,1.0,GAUSSIAN,rng);
 		//new_genome->mutate_link_weights(1.0,1.0,COLDGAUSSIAN);
-		new_genome->randomize_traits();
+		new_genome->randomize_traits(rng);
 		new_organism=new Organism(0.0,new_genome,1);
 		organisms.push_back(new_organism);
 	}
@@ -95,7 +101,7 @@ Population::Population(std::vector<Genome*> genomeList, float power) {
 	speciate();
 }
 
-Population::Population(const char *filename) {
+Population::Population(const char *filename,std::uint64_t seed) : rng(seed), thread_pool(0), deterministic_reproduction(true) {
 
 	char curword[128];  //max word size of 128 characters
 	char curline[1024]; //max line size of 1024 characters
@@ -138,7 +144,6 @@ Population::Population(const char *filename) {
 
                 int idcheck;
                 ss >> idcheck;
-                std::cout << idcheck << std::endl;
 
 				// If there isn't metadata, set metadata to ""
 				if(md == false)  {
@@ -215,9 +220,6 @@ Population::~Population() {
 		}
 	}
 
-	for (std::vector<Innovation*>::iterator iter = innovations.begin(); iter != innovations.end(); ++iter)
-		delete *iter;
-
 	//Delete the snapshots
 	//		for(cursnap=generation_snapshots.begin();cursnap!=generation_snapshots.end();++cursnap) {
 	//			delete (*cursnap);
@@ -251,9 +253,9 @@ bool Population::clone(Genome *g,int size, float power) {
 		//cout<<"CREATING ORGANISM "<<count<<endl;
 		new_genome=g->duplicate(count); 
 		if(power>0)
-			new_genome->mutate_link_weights(power,1.0,GAUSSIAN);
+			new_genome->mutate_link_weights(power,1.0,GAUSSIAN,rng);
 		
-		new_genome->randomize_traits();
+		new_genome->randomize_traits(rng);
 		new_organism=new Organism(0.0,new_genome,1);
 		organisms.push_back(new_organism);
 	}
@@ -280,8 +282,8 @@ bool Population::spawn(Genome *g,int size) {
 
 		new_genome=g->duplicate(count); 
 		//new_genome->mutate_link_weights(1.0,1.0,GAUSSIAN);
-		new_genome->mutate_link_weights(1.0,1.0,COLDGAUSSIAN);
-		new_genome->randomize_traits();
+		new_genome->mutate_link_weights(1.0,1.0,COLDGAUSSIAN,rng);
+		new_genome->randomize_traits(rng);
 		new_organism=new Organism(0.0,new_genome,1);
 		organisms.push_back(new_organism);
 	}
@@ -297,59 +299,10 @@ bool Population::spawn(Genome *g,int size) {
 }
 
 bool Population::speciate() {
-	std::vector<Organism*>::iterator curorg;  //For stepping through Population
-	std::vector<Species*>::iterator curspecies; //Steps through species
-	Organism *comporg=0;  //Organism for comparison 
-	Species *newspecies; //For adding a new species
-
-	int counter=0; //Species counter
-
-	//Step through all existing organisms
-	for(curorg=organisms.begin();curorg!=organisms.end();++curorg) {
-
-		//For each organism, search for a species it is compatible to
-		curspecies=species.begin();
-		if (curspecies==species.end()){
-			//Create the first species
-			newspecies=new Species(++counter);
-			species.push_back(newspecies);
-			newspecies->add_Organism(*curorg);  //Add the current organism
-			(*curorg)->species=newspecies;  //Point organism to its species
-		} 
-		else {
-			comporg=(*curspecies)->first();
-			while((comporg!=0)&&
-				(curspecies!=species.end())) {
-
-					if ((((*curorg)->gnome)->compatibility(comporg->gnome))<NEAT::compat_threshold) {
-
-						//Found compatible species, so add this organism to it
-						(*curspecies)->add_Organism(*curorg);
-						(*curorg)->species=(*curspecies);  //Point organism to its species
-						comporg=0;  //Note the search is over
-					}
-					else {
-
-						//Keep searching for a matching species
-						++curspecies;
-						if (curspecies!=species.end()) 
-							comporg=(*curspecies)->first();
-					}
-				}
-
-				//If we didn't find a match, create a new species
-				if (comporg!=0) {
-					newspecies=new Species(++counter);
-					species.push_back(newspecies);
-					newspecies->add_Organism(*curorg);  //Add the current organism
-					(*curorg)->species=newspecies;  //Point organism to its species
-				}
-
-		} //end else 
+	//Number the species from 1
+	last_species=0;
 
-	} //end for
-
-	last_species=counter;  //Keep track of highest species
+	speciateOrganisms(*this,organisms,false,thread_pool);
 
 	return true;
 }
@@ -404,6 +357,7 @@ bool Population::print_to_file_by_species(std::ofstream& outFile) {
 }
 
 bool Population::epoch(int generation) {
+	NEAT_PROFILE_SCOPE("epoch");
 
 	std::vector<Species*>::iterator curspecies;
 	std::vector<Species*>::iterator deadspecies;  //For removing empty Species
@@ -411,9 +365,6 @@ bool Population::epoch(int generation) {
 	std::vector<Organism*>::iterator curorg;
 	std::vector<Organism*>::iterator deadorg;
 
-	std::vector<Innovation*>::iterator curinnov;  
-	std::vector<Innovation*>::iterator deadinnov;  //For removing old Innovs
-
 	double total=0.0; //Used to compute average fitness over all Organisms
 
 	double overall_average;  //The average modified fitness among ALL organisms
@@ -517,8 +468,12 @@ bool Population::epoch(int generation) {
     neatDebugger()<<"Generation "<<generation<<": "<<"overall_average = "<<overall_average<<std::endl;
 
 	//Now compute expected number of offspring for each individual organism
+	//If nothing scored at all, e.g. in episodes cut short by a limit, there
+	//is no average to divide by and every organism expects one offspring
 	for(curorg=organisms.begin();curorg!=organisms.end();++curorg) {
-		(*curorg)->expected_offspring=(((*curorg)->fitness)/overall_average);
+		if (overall_average>0.0)
+			(*curorg)->expected_offspring=(((*curorg)->fitness)/overall_average);
+		else (*curorg)->expected_offspring=1.0;
 	}
 
 	//Now add those offspring up within each Species to get the number of
@@ -737,7 +692,7 @@ bool Population::epoch(int generation) {
 					(curspecies!=sorted_species.end())) {
 						//Randomize a little which species get boosted by a super champ
 
-						if (randfloat()>0.1)
+						if (rng.randfloat()>0.1)
 							if (stolen_babies>3) {
 								(*(((*curspecies)->organisms).begin()))->super_champ_offspring=3;
 								(*curspecies)->expected_offspring+=3;
@@ -821,28 +776,16 @@ bool Population::epoch(int generation) {
 	//}    
 
 
-	curspecies=species.begin();
-	int last_id=(*curspecies)->id;
-	while(curspecies!=species.end()) {
-	  (*curspecies)->reproduce(generation,this,sorted_species);
-
-	  //Set the current species to the id of the last species checked
-	  //(the iterator must be reset because there were possibly vector insertions during reproduce)
-	  std::vector<Species*>::iterator curspecies2=species.begin();
-	  while(curspecies2!=species.end()) {
-	    if (((*curspecies2)->id)==last_id)
-	      curspecies=curspecies2;
-	    curspecies2++;
-	  }
-
-	  //Move to the next on the list
-	  curspecies++;
-	  
-	  //Record where we are
-	  if (curspecies!=species.end())
-	    last_id=(*curspecies)->id;
+	//The babies are only put into Species once every Species has
+	//reproduced, so the parents all come from the old generation and
+	//the species list does not change during reproduction
+	std::vector<Organism*> babies;
+	reproduceSpecies(*this,generation,sorted_species,babies,thread_pool,deterministic_reproduction);
+	NEAT_PROFILE_COUNT("babies",babies.size());
 
-	}
+	//Add the babies to their proper Species
+	//If one doesn't fit a Species, a new one is created for it
+	speciateOrganisms(*this,babies,true,thread_pool);
 
 	//cout<<"Reproduction Complete"<<endl;
 
@@ -906,15 +849,7 @@ bool Population::epoch(int generation) {
 	}      
 
 	//Remove the innovations of the current generation
-	curinnov=innovations.begin();
-	while(curinnov!=innovations.end()) {
-		delete (*curinnov);
-
-		deadinnov=curinnov;
-		++curinnov;
-
-		curinnov=innovations.erase(deadinnov);
-	}
+	innovations.clear();
 
 	//DEBUG: Check to see if the best species died somehow
 	// We don't want this to happen
@@ -17,11 +17,14 @@
 #define _POPULATION_H_
 
 #include <cmath>
+#include <cstdint>
 #include <vector>
 #include "innovation.h"
 #include "genome.h"
 #include "species.h"
 #include "organism.h"
+#include "speciation.h"
+#include "thread_pool.h"
 
 namespace NEAT {
 
@@ -35,8 +38,13 @@ namespace NEAT {
 	// ---------------------------------------------  
 	class Population {
 
+		friend class Checkpoint;
+
 	protected: 
 
+		// An empty Population for Checkpoint to fill in
+		Population();
+
 		// A Population can be spawned off of a single Genome 
 		// There will be size Genomes added to the Population 
 		// The Population does not have to be empty to add Genomes 
@@ -49,12 +57,25 @@ namespace NEAT {
         std::vector<Species*> species;  // Species in the Population. Note that the species should comprise all the genomes 
 
 		// ******* Member variables used during reproduction *******
-        std::vector<Innovation*> innovations;  // For holding the genetic innovations of the newest generation
+        InnovationDatabase innovations;  // For holding the genetic innovations of the newest generation
 		int cur_node_id;  //Current label number available
 		double cur_innov_num;
 
 		int last_species;  //The highest species number
 
+		// ******* Random numbers *******
+		// Seeded with the master seed of the run, every random decision of
+		// the Population is drawn from it or from a stream split off it
+		RNG rng;
+
+		// ******* Parallelism *******
+		// Reproduction and speciation run on this pool when it is set
+		ThreadPool *thread_pool;
+
+		// Reconcile the innovations of the species in species order, so a
+		// run does not depend on the thread count (see reproduceSpecies)
+		bool deterministic_reproduction;
+
 		// ******* Fitness Statistics *******
 		double mean_fitness;
 		double variance;
@@ -94,14 +115,14 @@ namespace NEAT {
 		bool rank_within_species();
 
 		// Construct off of a single spawning Genome 
-		Population(Genome *g,int size);
+		Population(Genome *g,int size,std::uint64_t seed);
 
 		// Construct off of a single spawning Genome without mutation
-		Population(Genome *g,int size, float power);
+		Population(Genome *g,int size, float power,std::uint64_t seed);
 		
 		//MSC Addition
 		// Construct off of a vector of genomes with a mutation rate of "power"
-		Population(std::vector<Genome*> genomeList, float power);
+		Population(std::vector<Genome*> genomeList, float power,std::uint64_t seed);
 
 		bool clone(Genome *g,int size, float power);
 
@@ -111,7 +132,7 @@ namespace NEAT {
 		//Population(int size,int i,int o, int nmax, bool r, double linkprob);
 
 		// Construct off of a file of Genomes 
-		Population(const char *filename);
+		Population(const char *filename,std::uint64_t seed);
 
 		// It can delete a Population in two ways:
 		//    -delete by killing off the species
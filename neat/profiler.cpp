@@ -0,0 +1,251 @@
+#include "profiler.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+
+namespace NEAT
+{
+  namespace
+  {
+    struct TraceEvent
+    {
+      int                   phase;
+      Profiler::Clock::rep  start;
+      Profiler::Clock::rep  duration;
+    };
+
+    // What one thread recorded. Only the owner adds to the totals, collect
+    // takes them from another thread, so relaxed atomics are enough
+    struct ThreadData
+    {
+      std::array<std::atomic<std::uint64_t>, Profiler::MAX_PHASES>    nanoseconds {};
+      std::array<std::atomic<std::uint64_t>, Profiler::MAX_PHASES>    calls {};
+      std::array<std::atomic<std::uint64_t>, Profiler::MAX_COUNTERS>  counters {};
+
+      std::mutex                traceMutex;
+      std::vector<TraceEvent>   traceEvents;
+      int                       threadId = 0;
+    };
+
+    struct Registry
+    {
+      std::mutex                                  mutex;
+      std::vector<std::string>                    phaseNames;
+      std::array<bool, Profiler::MAX_PHASES>      phaseTraced {};
+      std::vector<std::string>                    counterNames;
+
+      // kept after their threads exit, so nothing recorded is lost
+      std::vector<std::unique_ptr<ThreadData>>    threads;
+
+      std::atomic<bool>                           tracing { false };
+      Profiler::Clock::time_point                 traceStart;
+    };
+
+    Registry& registry()
+    {
+      static Registry instance;
+      return instance;
+    }
+
+    ThreadData& threadData()
+    {
+      thread_local ThreadData* data = nullptr;
+      if(!data) {
+        auto& reg = registry();
+        std::lock_guard<std::mutex> lock(reg.mutex);
+        reg.threads.push_back(std::make_unique<ThreadData>());
+        data = reg.threads.back().get();
+        data->threadId = static_cast<int>(reg.threads.size());
+      }
+      return *data;
+    }
+
+    // phase and counter names are identifiers, only quotes and backslashes
+    // would need escaping
+    void writeString(std::ostream& out, const std::string& text)
+    {
+      out << '"';
+      for(auto c : text) {
+        if(c == '"' || c == '\\') {
+          out << '\\';
+        }
+        out << c;
+      }
+      out << '"';
+    }
+  }
+
+  int Profiler::registerPhase(const char* name, bool traced)
+  {
+    auto& reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+
+    // a phase timed at several places adds up under one name
+    auto found = std::find(reg.phaseNames.begin(), reg.phaseNames.end(), name);
+    if(found != reg.phaseNames.end()) {
+      return static_cast<int>(found - reg.phaseNames.begin());
+    }
+    if(reg.phaseNames.size() == MAX_PHASES) {
+      return -1;
+    }
+
+    reg.phaseTraced[reg.phaseNames.size()] = traced;
+    reg.phaseNames.emplace_back(name);
+    return static_cast<int>(reg.phaseNames.size() - 1);
+  }
+
+  int Profiler::registerCounter(const char* name)
+  {
+    auto& reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+
+    auto found = std::find(reg.counterNames.begin(), reg.counterNames.end(), name);
+    if(found != reg.counterNames.end()) {
+      return static_cast<int>(found - reg.counterNames.begin());
+    }
+    if(reg.counterNames.size() == MAX_COUNTERS) {
+      return -1;
+    }
+
+    reg.counterNames.emplace_back(name);
+    return static_cast<int>(reg.counterNames.size() - 1);
+  }
+
+  void Profiler::record(int phase, Clock::time_point start, Clock::time_point end)
+  {
+    if(phase < 0) {
+      return;
+    }
+
+    auto& data = threadData();
+    auto duration = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+    data.nanoseconds[phase].fetch_add(static_cast<std::uint64_t>(duration), std::memory_order_relaxed);
+    data.calls[phase].fetch_add(1, std::memory_order_relaxed);
+
+    auto& reg = registry();
+    if(reg.tracing.load(std::memory_order_acquire)) {
+      // the flag is set before the phase id is handed out and never changes
+      if(reg.phaseTraced[phase]) {
+        std::lock_guard<std::mutex> lock(data.traceMutex);
+        data.traceEvents.push_back({ phase, (start - reg.traceStart).count(), (end - start).count() });
+      }
+    }
+  }
+
+  void Profiler::count(int counter, std::uint64_t value)
+  {
+    if(counter >= 0) {
+      threadData().counters[counter].fetch_add(value, std::memory_order_relaxed);
+    }
+  }
+
+  Profiler::Generation Profiler::collect(std::uint64_t generation)
+  {
+    auto& reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+
+    std::vector<std::uint64_t> nanoseconds(reg.phaseNames.size(), 0);
+    std::vector<std::uint64_t> calls(reg.phaseNames.size(), 0);
+    std::vector<std::uint64_t> counters(reg.counterNames.size(), 0);
+    for(auto& data : reg.threads) {
+      for(std::size_t i = 0; i < nanoseconds.size(); ++i) {
+        nanoseconds[i] += data->nanoseconds[i].exchange(0, std::memory_order_relaxed);
+        calls[i] += data->calls[i].exchange(0, std::memory_order_relaxed);
+      }
+      for(std::size_t i = 0; i < counters.size(); ++i) {
+        counters[i] += data->counters[i].exchange(0, std::memory_order_relaxed);
+      }
+    }
+
+    Generation result;
+    result.generation = generation;
+    for(std::size_t i = 0; i < nanoseconds.size(); ++i) {
+      if(calls[i] > 0) {
+        result.phases.push_back({ reg.phaseNames[i], nanoseconds[i] / 1e6, calls[i] });
+      }
+    }
+    for(std::size_t i = 0; i < counters.size(); ++i) {
+      if(counters[i] > 0) {
+        result.counters.push_back({ reg.counterNames[i], counters[i] });
+      }
+    }
+    return result;
+  }
+
+  std::string Profiler::format(const Generation& generation)
+  {
+    std::ostringstream out;
+    out << "{\"generation\":" << generation.generation << ",\"phases\":{";
+    for(std::size_t i = 0; i < generation.phases.size(); ++i) {
+      const auto& phase = generation.phases[i];
+
+      char milliseconds[32];
+      std::snprintf(milliseconds, sizeof(milliseconds), "%.3f", phase.milliseconds);
+
+      out << (i > 0 ? "," : "");
+      writeString(out, phase.name);
+      out << ":{\"ms\":" << milliseconds << ",\"calls\":" << phase.calls << "}";
+    }
+    out << "},\"counters\":{";
+    for(std::size_t i = 0; i < generation.counters.size(); ++i) {
+      out << (i > 0 ? "," : "");
+      writeString(out, generation.counters[i].name);
+      out << ":" << generation.counters[i].value;
+    }
+    out << "}}";
+    return out.str();
+  }
+
+  void Profiler::startTrace()
+  {
+    auto& reg = registry();
+    {
+      std::lock_guard<std::mutex> lock(reg.mutex);
+      reg.traceStart = Clock::now();
+      for(auto& data : reg.threads) {
+        std::lock_guard<std::mutex> traceLock(data->traceMutex);
+        data->traceEvents.clear();
+      }
+    }
+    reg.tracing.store(true, std::memory_order_release);
+  }
+
+  bool Profiler::writeTrace(const std::string& filename)
+  {
+    std::ofstream out(filename);
+    if(!out.is_open()) {
+      return false;
+    }
+
+    auto& reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+
+    // complete events ("ph":"X") with timestamps in microseconds
+    auto first = true;
+    out << "{\"traceEvents\":[";
+    for(auto& data : reg.threads) {
+      std::lock_guard<std::mutex> traceLock(data->traceMutex);
+      for(const auto& event : data->traceEvents) {
+        auto start = std::chrono::duration<double, std::micro>(Clock::duration(event.start)).count();
+        auto duration = std::chrono::duration<double, std::micro>(Clock::duration(event.duration)).count();
+
+        char times[64];
+        std::snprintf(times, sizeof(times), "\"ts\":%.3f,\"dur\":%.3f", start, duration);
+
+        out << (first ? "\n" : ",\n") << "{\"name\":";
+        writeString(out, reg.phaseNames[event.phase]);
+        out << ",\"ph\":\"X\"," << times << ",\"pid\":1,\"tid\":" << data->threadId << "}";
+        first = false;
+      }
+    }
+    out << "\n],\"displayTimeUnit\":\"ms\"}\n";
+
+    return static_cast<bool>(out);
+  }
+}
@@ -0,0 +1,109 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace NEAT
+{
+  // Scoped timers and counters that show where the time of a generation
+  // goes. Every thread adds to totals of its own, collect() sums and resets
+  // them once per generation. Phases entered on several threads at once
+  // report the time summed over the threads.
+  //
+  // Only the NEAT_PROFILE_* macros should be used in timed code, they
+  // compile to nothing unless NEAT_PROFILING is defined
+  class Profiler
+  {
+  public:
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr std::size_t MAX_PHASES = 64;
+    static constexpr std::size_t MAX_COUNTERS = 64;
+
+    struct Phase
+    {
+      std::string     name;
+      double          milliseconds;
+      std::uint64_t   calls;
+    };
+
+    struct Counter
+    {
+      std::string     name;
+      std::uint64_t   value;
+    };
+
+    struct Generation
+    {
+      std::uint64_t         generation;
+      std::vector<Phase>    phases;
+      std::vector<Counter>  counters;
+    };
+
+    // A traced phase also goes into the trace while one is recorded, the
+    // hot ones entered millions of times per generation are only summed
+    static int registerPhase(const char* name, bool traced);
+    static int registerCounter(const char* name);
+
+    static void record(int phase, Clock::time_point start, Clock::time_point end);
+    static void count(int counter, std::uint64_t value);
+
+    // What was recorded since the previous call, phases and counters that
+    // saw no use are left out
+    static Generation collect(std::uint64_t generation);
+
+    // One line of JSON:
+    // {"generation":1,"phases":{"epoch":{"ms":1.5,"calls":1}},"counters":{"babies":100}}
+    static std::string format(const Generation& generation);
+
+    // Records the traced phases from now on, writeTrace saves them in the
+    // Chrome trace event format (chrome://tracing, Perfetto)
+    static void startTrace();
+    static bool writeTrace(const std::string& filename);
+  };
+
+  class ProfileScope
+  {
+  public:
+    explicit ProfileScope(int phase) : m_phase(phase), m_start(Profiler::Clock::now()) {}
+    ~ProfileScope() { Profiler::record(m_phase, m_start, Profiler::Clock::now()); }
+
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+
+  private:
+    int                           m_phase;
+    Profiler::Clock::time_point   m_start;
+  };
+}
+
+#ifdef NEAT_PROFILING
+#define NEAT_PROFILE_CONCAT_(a, b) a##b
+#define NEAT_PROFILE_CONCAT(a, b) NEAT_PROFILE_CONCAT_(a, b)
+
+// Times the rest of the enclosing block as the phase name
+#define NEAT_PROFILE_SCOPE(name) \
+  static const int NEAT_PROFILE_CONCAT(neatProfilePhase, __LINE__) = NEAT::Profiler::registerPhase(name, true); \
+  NEAT::ProfileScope NEAT_PROFILE_CONCAT(neatProfileScope, __LINE__)(NEAT_PROFILE_CONCAT(neatProfilePhase, __LINE__))
+
+// Same for phases too frequent to trace one by one
+#define NEAT_PROFILE_HOT_SCOPE(name) \
+  static const int NEAT_PROFILE_CONCAT(neatProfilePhase, __LINE__) = NEAT::Profiler::registerPhase(name, false); \
+  NEAT::ProfileScope NEAT_PROFILE_CONCAT(neatProfileScope, __LINE__)(NEAT_PROFILE_CONCAT(neatProfilePhase, __LINE__))
+
+#define NEAT_PROFILE_COUNT(name, value) \
+  do { \
+    static const int neatProfileCounter = NEAT::Profiler::registerCounter(name); \
+    NEAT::Profiler::count(neatProfileCounter, static_cast<std::uint64_t>(value)); \
+  } while(false)
+#else
+#define NEAT_PROFILE_SCOPE(name) ((void)0)
+#define NEAT_PROFILE_HOT_SCOPE(name) ((void)0)
+#define NEAT_PROFILE_COUNT(name, value) ((void)0)
+#endif
+
+#endif // PROFILER_H
@@ -0,0 +1,163 @@
+#include "reproduction.h"
+
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <unordered_map>
+
+#include "genome.h"
+#include "innovation.h"
+#include "organism.h"
+#include "population.h"
+#include "profiler.h"
+#include "species.h"
+#include "thread_pool.h"
+
+namespace NEAT
+{
+  namespace
+  {
+    // What one species produced in deterministic mode
+    struct SpeciesOffspring
+    {
+      InnovationDatabase      innovations;
+      int                     curNodeId;
+      double                  curInnovNum;
+      std::vector<Organism*>  babies;
+    };
+
+    // Moves the provisional innovations of offspring into the population
+    // and renumbers its babies. Ids at or above the bases were handed out
+    // during this reproduction and are provisional, lower ones are final
+    void reconcile(Population& population, SpeciesOffspring& offspring, int nodeBase, double innovBase)
+    {
+      std::unordered_map<int, int> nodeIds;
+      std::unordered_map<double, double> innovationNums;
+      auto mapNode = [&](int id) { return id >= nodeBase ? nodeIds.at(id) : id; };
+      auto mapInnovation = [&](double num) { return num >= innovBase ? innovationNums.at(num) : num; };
+
+      // an innovation only refers to ones recorded before it
+      for(const auto* provisional : offspring.innovations.get_innovations()) {
+        auto in = mapNode(provisional->node_in_id);
+        auto out = mapNode(provisional->node_out_id);
+
+        if(static_cast<int>(provisional->innovation_type) == NEWNODE) {
+          auto split = mapInnovation(provisional->old_innov_num);
+          auto* innovation = population.innovations.find_node(in, out, split);
+          if(!innovation) {
+            innovation = new Innovation(in, out, population.cur_innov_num, population.cur_innov_num + 1.0,
+                                        population.cur_node_id++, split);
+            population.cur_innov_num += 2.0;
+            population.innovations.add(innovation);
+          }
+
+          nodeIds[provisional->newnode_id] = innovation->newnode_id;
+          innovationNums[provisional->innovation_num1] = innovation->innovation_num1;
+          innovationNums[provisional->innovation_num2] = innovation->innovation_num2;
+        } else {
+          auto* innovation = population.innovations.find_link(in, out, provisional->recur_flag);
+          if(!innovation) {
+            innovation = new Innovation(in, out, population.cur_innov_num, provisional->new_weight,
+                                        provisional->new_traitnum);
+            innovation->recur_flag = provisional->recur_flag;
+            population.cur_innov_num += 1.0;
+            population.innovations.add(innovation);
+          }
+
+          innovationNums[provisional->innovation_num1] = innovation->innovation_num1;
+        }
+      }
+
+      if(nodeIds.empty() && innovationNums.empty()) {
+        return;
+      }
+
+      for(auto* baby : offspring.babies) {
+        auto* genome = baby->gnome;
+
+        bool renumbered = false;
+        for(auto* node : genome->nodes) {
+          if(node->node_id >= nodeBase) {
+            node->node_id = mapNode(node->node_id);
+            renumbered = true;
+          }
+        }
+        for(auto* gene : genome->genes) {
+          if(gene->innovation_num >= innovBase) {
+            gene->innovation_num = mapInnovation(gene->innovation_num);
+            renumbered = true;
+          }
+        }
+
+        // the final numbers may order differently than the provisional ones
+        if(renumbered) {
+          std::stable_sort(genome->nodes.begin(), genome->nodes.end(), [](const NNode* a, const NNode* b) {
+            return a->node_id < b->node_id;
+          });
+          std::stable_sort(genome->genes.begin(), genome->genes.end(), [](const Gene* a, const Gene* b) {
+            return a->innovation_num < b->innovation_num;
+          });
+        }
+      }
+    }
+  }
+
+  void reproduceSpecies(Population& population, int generation, std::vector<Species*>& sortedSpecies,
+                        std::vector<Organism*>& babies, ThreadPool* pool, bool deterministic)
+  {
+    NEAT_PROFILE_SCOPE("reproduce");
+    auto& species = population.species;
+
+    std::vector<RNG> streams;
+    streams.reserve(species.size());
+    for(std::size_t i = 0; i < species.size(); ++i) {
+      streams.push_back(population.rng.split());
+    }
+
+    auto run = [&](std::size_t count, const std::function<void(std::size_t)>& task) {
+      if(pool && count > 1) {
+        pool->parallelFor(count, task);
+      } else {
+        for(std::size_t i = 0; i < count; ++i) {
+          task(i);
+        }
+      }
+    };
+
+    if(!deterministic) {
+      std::vector<std::vector<Organism*>> offspring(species.size());
+      run(species.size(), [&](std::size_t i) {
+        species[i]->reproduce(generation, population.innovations, population.cur_node_id, population.cur_innov_num,
+                              sortedSpecies, streams[i], offspring[i]);
+      });
+
+      for(auto& speciesBabies : offspring) {
+        babies.insert(babies.end(), speciesBabies.begin(), speciesBabies.end());
+      }
+      return;
+    }
+
+    const auto nodeBase = population.cur_node_id;
+    const auto innovBase = population.cur_innov_num;
+
+    std::vector<std::unique_ptr<SpeciesOffspring>> offspring;
+    offspring.reserve(species.size());
+    for(std::size_t i = 0; i < species.size(); ++i) {
+      offspring.push_back(std::make_unique<SpeciesOffspring>());
+      offspring.back()->curNodeId = nodeBase;
+      offspring.back()->curInnovNum = innovBase;
+    }
+
+    run(species.size(), [&](std::size_t i) {
+      auto& result = *offspring[i];
+      species[i]->reproduce(generation, result.innovations, result.curNodeId, result.curInnovNum,
+                            sortedSpecies, streams[i], result.babies);
+    });
+
+    NEAT_PROFILE_SCOPE("reconcile");
+    for(auto& result : offspring) {
+      reconcile(population, *result, nodeBase, innovBase);
+      babies.insert(babies.end(), result->babies.begin(), result->babies.end());
+    }
+  }
+}
@@ -0,0 +1,35 @@
+#ifndef REPRODUCTION_H
+#define REPRODUCTION_H
+
+#include <vector>
+
+namespace NEAT
+{
+  class Organism;
+  class Population;
+  class Species;
+  class ThreadPool;
+
+  // Runs Species::reproduce for every species of the population, on pool
+  // when one is given, and appends the babies to babies in species order.
+  // Every species draws from its own stream, split off population.rng in
+  // species order. The babies are allocated on the threads of pool and
+  // deleted by a later epoch on the calling thread, Pool hands the slots
+  // they leave back to the threads that allocate.
+  //
+  // Deterministic: every species records its structural innovations in a
+  // database of its own, numbering them provisionally from the counters of
+  // the population. Once all are done the innovations are reconciled in
+  // species order: one already in population.innovations gives its node
+  // id and innovation numbers, a novel one takes the next ones, and the
+  // babies are renumbered. The result does not depend on the thread count.
+  // A reused link innovation keeps the weight its baby drew for it
+  //
+  // Otherwise the species share population.innovations and its counters,
+  // taken under the database mutex, and the numbering follows whichever
+  // species gets there first
+  void reproduceSpecies(Population& population, int generation, std::vector<Species*>& sortedSpecies,
+                        std::vector<Organism*>& babies, ThreadPool* pool, bool deterministic);
+}
+
+#endif // REPRODUCTION_H
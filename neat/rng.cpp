@@ -0,0 +1,168 @@
+#include "rng.h"
+
+#include <chrono>
+#include <cmath>
+#include <random>
+
+namespace NEAT
+{
+  namespace
+  {
+    std::uint64_t rotl(std::uint64_t x, int k)
+    {
+      return (x << k) | (x >> (64 - k));
+    }
+
+    std::uint64_t splitMix64(std::uint64_t& x)
+    {
+      auto z = (x += 0x9E3779B97F4A7C15ULL);
+      z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+      z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+      return z ^ (z >> 31);
+    }
+  }
+
+  RNG::RNG(std::uint64_t seed)
+  {
+    this->seed(seed);
+  }
+
+  void RNG::seed(std::uint64_t seed)
+  {
+    // xoshiro must not start from an all zero state, splitmix64 never
+    // returns four zeros in a row
+    auto x = seed;
+    for(auto& state : m_state) {
+      state = splitMix64(x);
+    }
+
+    m_seed = seed;
+    m_stream = 0;
+    m_hasGauss = false;
+  }
+
+  RNG::State RNG::getState() const
+  {
+    State state;
+    for(int i = 0; i < 4; ++i) {
+      state.words[i] = m_state[i];
+    }
+    state.seed = m_seed;
+    state.stream = m_stream;
+    state.gauss = m_hasGauss ? m_gauss : 0.0;
+    state.hasGauss = m_hasGauss;
+
+    return state;
+  }
+
+  void RNG::setState(const State& state)
+  {
+    for(int i = 0; i < 4; ++i) {
+      m_state[i] = state.words[i];
+    }
+    m_seed = state.seed;
+    m_stream = state.stream;
+    m_gauss = state.gauss;
+    m_hasGauss = state.hasGauss;
+  }
+
+  RNG RNG::stream(std::uint64_t index) const
+  {
+    RNG rng(m_seed);
+    for(std::uint64_t i = 0; i < index; ++i) {
+      rng.jump();
+    }
+    rng.m_stream = index;
+
+    return rng;
+  }
+
+  RNG RNG::split()
+  {
+    return RNG(next());
+  }
+
+  std::uint64_t RNG::next()
+  {
+    auto result = rotl(m_state[0] + m_state[3], 23) + m_state[0];
+    auto t = m_state[1] << 17;
+
+    m_state[2] ^= m_state[0];
+    m_state[3] ^= m_state[1];
+    m_state[1] ^= m_state[2];
+    m_state[0] ^= m_state[3];
+    m_state[2] ^= t;
+    m_state[3] = rotl(m_state[3], 45);
+
+    return result;
+  }
+
+  int RNG::randint(int x, int y)
+  {
+    // the range is small enough for the modulo bias not to matter
+    auto range = static_cast<std::uint64_t>(static_cast<std::int64_t>(y) - x + 1);
+    return static_cast<int>(x + static_cast<std::int64_t>(next() % range));
+  }
+
+  double RNG::randfloat()
+  {
+    // 53 random bits spread over [0, 1] inclusive like rand() / RAND_MAX
+    return static_cast<double>(next() >> 11) / static_cast<double>((1ULL << 53) - 1);
+  }
+
+  int RNG::randposneg()
+  {
+    return (next() >> 63) ? 1 : -1;
+  }
+
+  double RNG::gaussrand()
+  {
+    // polar Box-Muller, every other call returns the cached deviate
+    if(m_hasGauss) {
+      m_hasGauss = false;
+      return m_gauss;
+    }
+
+    double v1, v2, rsq;
+    do {
+      v1 = 2.0 * randfloat() - 1.0;
+      v2 = 2.0 * randfloat() - 1.0;
+      rsq = v1 * v1 + v2 * v2;
+    } while(rsq >= 1.0 || rsq == 0.0);
+
+    auto fac = std::sqrt(-2.0 * std::log(rsq) / rsq);
+    m_gauss = v1 * fac;
+    m_hasGauss = true;
+
+    return v2 * fac;
+  }
+
+  std::uint64_t RNG::makeSeed()
+  {
+    std::random_device device;
+    auto seed = (static_cast<std::uint64_t>(device()) << 32) ^ device();
+    return seed ^ static_cast<std::uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+  }
+
+  void RNG::jump()
+  {
+    static const std::uint64_t JUMP[] = { 0x180EC6D33CFD0ABAULL, 0xD5A61266F0C9392CULL,
+                                          0xA9582618E03FC9AAULL, 0x39ABDC4529B1661CULL };
+
+    std::uint64_t s[4] = { 0, 0, 0, 0 };
+    for(auto jump : JUMP) {
+      for(int b = 0; b < 64; ++b) {
+        if(jump & (1ULL << b)) {
+          for(int i = 0; i < 4; ++i) {
+            s[i] ^= m_state[i];
+          }
+        }
+        next();
+      }
+    }
+
+    for(int i = 0; i < 4; ++i) {
+      m_state[i] = s[i];
+    }
+  }
+}
@@ -0,0 +1,65 @@
+#ifndef RNG_H
+#define RNG_H
+
+#include <cstdint>
+
+namespace NEAT
+{
+  // xoshiro256++ random number generator. Everything random in NEAT draws
+  // from an RNG that is passed in, so a run only depends on its master seed.
+  // Parallel code gives every thread or task its own stream instead of
+  // sharing one generator
+  class RNG
+  {
+  public:
+    // Everything needed to continue the sequence, for checkpoints
+    struct State
+    {
+      std::uint64_t   words[4];
+      std::uint64_t   seed;
+      std::uint64_t   stream;
+      double          gauss;
+      bool            hasGauss;
+    };
+
+    explicit RNG(std::uint64_t seed = 0);
+
+    void seed(std::uint64_t seed);
+
+    // Seed the generator was created with, and which stream of it this is
+    std::uint64_t getSeed() const { return m_seed; }
+    std::uint64_t getStream() const { return m_stream; }
+
+    State getState() const;
+    void setState(const State& state);
+
+    // Stream index of the master seed, 2^128 draws apart from the others
+    RNG stream(std::uint64_t index) const;
+
+    // New generator seeded from the next draw of this one. Splitting in a
+    // fixed order hands out the same generators however the work is scheduled
+    RNG split();
+
+    std::uint64_t next();
+
+    // Same meaning as the classic NEAT helpers
+    int randint(int x, int y);   // in [x, y]
+    double randfloat();          // in [0, 1]
+    int randposneg();            // 1 or -1
+    double gaussrand();          // normal, mean 0 and variance 1
+
+    // A seed from the system for runs that are not given one
+    static std::uint64_t makeSeed();
+
+  private:
+    void jump();
+
+    std::uint64_t   m_state[4];
+    std::uint64_t   m_seed;
+    std::uint64_t   m_stream;
+    double          m_gauss;
+    bool            m_hasGauss;
+  };
+}
+
+#endif // RNG_H
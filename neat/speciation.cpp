@@ -0,0 +1,155 @@
+#include "speciation.h"
+
+#include <algorithm>
+
+#include "genome.h"
+#include "neat.h"
+#include "organism.h"
+#include "population.h"
+#include "profiler.h"
+#include "species.h"
+#include "thread_pool.h"
+
+namespace NEAT
+{
+  namespace
+  {
+    constexpr std::size_t NO_SPECIES = static_cast<std::size_t>(-1);
+
+    // organisms compared by one task
+    constexpr std::size_t ORGANISMS_PER_TASK = 16;
+  }
+
+  CompatibilityProfile::CompatibilityProfile(const Genome& genome)
+  {
+    m_genes.reserve(genome.genes.size());
+    for(const auto* gene : genome.genes) {
+      m_genes.push_back({ gene->innovation_num, gene->mutation_num });
+    }
+  }
+
+  double CompatibilityProfile::distance(const CompatibilityProfile& other, double threshold) const
+  {
+    // the disjoint and excess terms only grow and the mutation term is
+    // never negative, so their sum so far is a lower bound of the distance
+    const bool canStopEarly = disjoint_coeff >= 0.0 && excess_coeff >= 0.0 && mutdiff_coeff >= 0.0;
+
+    // same order of operations as Genome::compatibility, so the distances
+    // are bit for bit the same
+    double numDisjoint = 0.0;
+    double numExcess = 0.0;
+    double mutDiffTotal = 0.0;
+    double numMatching = 0.0;
+
+    const auto* p1 = m_genes.data();
+    const auto* p1End = p1 + m_genes.size();
+    const auto* p2 = other.m_genes.data();
+    const auto* p2End = p2 + other.m_genes.size();
+
+    while(p1 != p1End && p2 != p2End) {
+      if(p1->innovation == p2->innovation) {
+        numMatching += 1.0;
+        auto mutDiff = p1->mutation - p2->mutation;
+        if(mutDiff < 0.0) {
+          mutDiff = 0.0 - mutDiff;
+        }
+        mutDiffTotal += mutDiff;
+
+        ++p1;
+        ++p2;
+      } else {
+        if(p1->innovation < p2->innovation) {
+          ++p1;
+        } else {
+          ++p2;
+        }
+        numDisjoint += 1.0;
+
+        auto partial = disjoint_coeff * numDisjoint + excess_coeff * numExcess;
+        if(canStopEarly && partial >= threshold) {
+          return partial;
+        }
+      }
+    }
+
+    // whatever is left of the longer genome is excess
+    numExcess += static_cast<double>((p1End - p1) + (p2End - p2));
+
+    return disjoint_coeff * (numDisjoint / 1.0) +
+           excess_coeff * (numExcess / 1.0) +
+           mutdiff_coeff * (mutDiffTotal / numMatching);
+  }
+
+  void speciateOrganisms(Population& population, const std::vector<Organism*>& organisms, bool novel,
+                         ThreadPool* pool)
+  {
+    NEAT_PROFILE_SCOPE("speciate");
+    NEAT_PROFILE_COUNT("speciated", organisms.size());
+
+    const auto threshold = compat_threshold;
+
+    // an empty species has no representative and takes no organisms
+    std::vector<Species*> existing;
+    std::vector<CompatibilityProfile> representatives;
+    for(auto* species : population.species) {
+      if(!species->organisms.empty()) {
+        existing.push_back(species);
+        representatives.emplace_back(*species->first()->gnome);
+      }
+    }
+
+    std::vector<std::size_t> matches(organisms.size(), NO_SPECIES);
+    auto findMatches = [&](std::size_t task) {
+      auto end = std::min(organisms.size(), (task + 1) * ORGANISMS_PER_TASK);
+      for(auto i = task * ORGANISMS_PER_TASK; i < end; ++i) {
+        CompatibilityProfile profile(*organisms[i]->gnome);
+        for(std::size_t s = 0; s < representatives.size(); ++s) {
+          if(profile.distance(representatives[s], threshold) < threshold) {
+            matches[i] = s;
+            break;
+          }
+        }
+      }
+    };
+
+    auto taskCount = (organisms.size() + ORGANISMS_PER_TASK - 1) / ORGANISMS_PER_TASK;
+    if(pool && taskCount > 1 && !representatives.empty()) {
+      pool->parallelFor(taskCount, findMatches);
+    } else {
+      for(std::size_t task = 0; task < taskCount; ++task) {
+        findMatches(task);
+      }
+    }
+
+    // species created here come after the existing ones, so an organism
+    // that fit none of those is compared against them in order
+    std::vector<Species*> created;
+    std::vector<CompatibilityProfile> createdRepresentatives;
+    for(std::size_t i = 0; i < organisms.size(); ++i) {
+      auto* organism = organisms[i];
+      Species* species = nullptr;
+
+      if(matches[i] != NO_SPECIES) {
+        species = existing[matches[i]];
+      } else {
+        CompatibilityProfile profile(*organism->gnome);
+        for(std::size_t s = 0; s < created.size(); ++s) {
+          if(profile.distance(createdRepresentatives[s], threshold) < threshold) {
+            species = created[s];
+            break;
+          }
+        }
+
+        if(!species) {
+          species = new Species(++population.last_species, novel);
+          population.species.push_back(species);
+          created.push_back(species);
+          createdRepresentatives.push_back(std::move(profile));
+        }
+      }
+
+      species->add_Organism(organism);
+      organism->species = species;
+    }
+  }
+}
@@ -0,0 +1,46 @@
+#ifndef SPECIATION_H
+#define SPECIATION_H
+
+#include <cstddef>
+#include <vector>
+
+namespace NEAT
+{
+  class Genome;
+  class Organism;
+  class Population;
+  class ThreadPool;
+
+  // The genes of a genome reduced to what Genome::compatibility looks at,
+  // innovation and mutation numbers in gene order in one contiguous array
+  class CompatibilityProfile
+  {
+  public:
+    explicit CompatibilityProfile(const Genome& genome);
+
+    // Genome::compatibility of the two genomes, except that it stops as
+    // soon as the distance is known to reach threshold and then returns a
+    // partial distance that is at least threshold
+    double distance(const CompatibilityProfile& other, double threshold) const;
+
+  private:
+    struct Gene
+    {
+      double innovation;
+      double mutation;
+    };
+
+    std::vector<Gene>   m_genes;
+  };
+
+  // Adds every organism to the first species of the population it is
+  // compatible with and creates a new species for the ones that fit none,
+  // numbered from population.last_species. The comparisons against the
+  // species that exist beforehand run in parallel on pool when one is
+  // given. The organisms are placed in order, so the species come out the
+  // same as when comparing one organism at a time
+  void speciateOrganisms(Population& population, const std::vector<Organism*>& organisms, bool novel,
+                         ThreadPool* pool);
+}
+
+#endif // SPECIATION_H
@@ -15,6 +15,7 @@
 */
 #include "species.h"
 #include "organism.h"
+#include "profiler.h"
 #include <cmath>
 #include <iostream>
 using namespace NEAT;
@@ -404,7 +405,8 @@ double Species::count_offspring(double skim) {
 
 }
 
-bool Species::reproduce(int generation, Population *pop,std::vector<Species*> &sorted_species) {
+bool Species::reproduce(int generation,InnovationDatabase &innovs,int &cur_node_id,double &cur_innov_num,std::vector<Species*> &sorted_species,RNG &rng,std::vector<Organism*> &babies) {
+	NEAT_PROFILE_SCOPE("species_reproduce");
 	int count;
 	std::vector<Organism*>::iterator curorg;
 
@@ -418,23 +420,16 @@ bool Species::reproduce(int generation, Population *pop,std::vector<Species*> &s
 
 	Genome *new_genome;  //For holding baby's genes
 
-	std::vector<Species*>::iterator curspecies;  //For adding baby
-	Species *newspecies; //For babies in new Species
-	Organism *comporg;  //For Species determination through comparison
-
 	Species *randspecies;  //For mating outside the Species
 	double randmult;
 	int randspeciesnum;
 	int spcount;  
 	std::vector<Species*>::iterator cursp;
 
-	Network *net_analogue;  //For adding link to test for recurrency
 	int pause;
 
 	bool outside;
 
-	bool found;  //When a Species is found
-
 	bool champ_done=false; //Flag the preservation of the champion  
 
 	Organism *thechamp;
@@ -501,16 +496,14 @@ bool Species::reproduce(int generation, Population *pop,std::vector<Species*> &s
 				//Note: Superchamp offspring only occur with stolen babies!
 				//      Settings used for published experiments did not use this
 				if ((thechamp->super_champ_offspring) > 1) {
-					if ((randfloat()<0.8)||
+					if ((rng.randfloat()<0.8)||
 						(NEAT::mutate_add_link_prob==0.0)) 
 						//ABOVE LINE IS FOR:
 						//Make sure no links get added when the system has link adding disabled
-						new_genome->mutate_link_weights(mut_power,1.0,GAUSSIAN);
+						new_genome->mutate_link_weights(mut_power,1.0,GAUSSIAN,rng);
 					else {
 						//Sometimes we add a link to a superchamp
-						net_analogue=new_genome->genesis(generation);
-						new_genome->mutate_add_link(pop->innovations,pop->cur_innov_num,NEAT::newlink_tries);
-						delete net_analogue;
+						new_genome->mutate_add_link(innovs,cur_innov_num,NEAT::newlink_tries,rng);
 						mut_struct_baby=true;
 					}
 				}
@@ -542,13 +535,13 @@ bool Species::reproduce(int generation, Population *pop,std::vector<Species*> &s
 				}
 				//First, decide whether to mate or mutate
 				//If there is only one organism in the pool, then always mutate
-			else if ((randfloat()<NEAT::mutate_only_prob)||
+			else if ((rng.randfloat()<NEAT::mutate_only_prob)||
 				poolsize== 0) {
 
 					//Choose the random parent
 
 					//RANDOM PARENT CHOOSER
-					orgnum=randint(0,poolsize);
+					orgnum=rng.randint(0,poolsize);
 					curorg=organisms.begin();
 					for(orgcount=0;orgcount<orgnum;orgcount++)
 						++curorg;                       
@@ -575,16 +568,14 @@ bool Species::reproduce(int generation, Population *pop,std::vector<Species*> &s
 					//Do the mutation depending on probabilities of 
 					//various mutations
 
-					if (randfloat()<NEAT::mutate_add_node_prob) {
+					if (rng.randfloat()<NEAT::mutate_add_node_prob) {
 						//std::cout<<"mutate add node"<<std::endl;
-						new_genome->mutate_add_node(pop->innovations,pop->cur_node_id,pop->cur_innov_num);
+						new_genome->mutate_add_node(innovs,cur_node_id,cur_innov_num,rng);
 						mut_struct_baby=true;
 					}
-					else if (randfloat()<NEAT::mutate_add_link_prob) {
+					else if (rng.randfloat()<NEAT::mutate_add_link_prob) {
 						//std::cout<<"mutate add link"<<std::endl;
-						net_analogue=new_genome->genesis(generation);
-						new_genome->mutate_add_link(pop->innovations,pop->cur_innov_num,NEAT::newlink_tries);
-						delete net_analogue;
+						new_genome->mutate_add_link(innovs,cur_innov_num,NEAT::newlink_tries,rng);
 						mut_struct_baby=true;
 					}
 					//NOTE:  A link CANNOT be added directly after a node was added because the phenotype
@@ -592,28 +583,28 @@ bool Species::reproduce(int generation, Population *pop,std::vector<Species*> &s
 					else {
 						//If we didn't do a structural mutation, we do the other kinds
 
-						if (randfloat()<NEAT::mutate_random_trait_prob) {
+						if (rng.randfloat()<NEAT::mutate_random_trait_prob) {
 							//std::cout<<"mutate random trait"<<std::endl;
-							new_genome->mutate_random_trait();
+							new_genome->mutate_random_trait(rng);
 						}
-						if (randfloat()<NEAT::mutate_link_trait_prob) {
+						if (rng.randfloat()<NEAT::mutate_link_trait_prob) {
 							//std::cout<<"mutate_link_trait"<<std::endl;
-							new_genome->mutate_link_trait(1);
+							new_genome->mutate_link_trait(1,rng);
 						}
-						if (randfloat()<NEAT::mutate_node_trait_prob) {
+						if (rng.randfloat()<NEAT::mutate_node_trait_prob) {
 							//std::cout<<"mutate_node_trait"<<std::endl;
-							new_genome->mutate_node_trait(1);
+							new_genome->mutate_node_trait(1,rng);
 						}
-						if (randfloat()<NEAT::mutate_link_weights_prob) {
+						if (rng.randfloat()<NEAT::mutate_link_weights_prob) {
 							//std::cout<<"mutate_link_weights"<<std::endl;
-							new_genome->mutate_link_weights(mut_power,1.0,GAUSSIAN);
+							new_genome->mutate_link_weights(mut_power,1.0,GAUSSIAN,rng);
 						}
-						if (randfloat()<NEAT::mutate_toggle_enable_prob) {
+						if (rng.randfloat()<NEAT::mutate_toggle_enable_prob) {
 							//std::cout<<"mutate toggle enable"<<std::endl;
-							new_genome->mutate_toggle_enable(1);
+							new_genome->mutate_toggle_enable(1,rng);
 
 						}
-						if (randfloat()<NEAT::mutate_gene_reenable_prob) {
+						if (rng.randfloat()<NEAT::mutate_gene_reenable_prob) {
 							//std::cout<<"mutate gene reenable"<<std::endl;
 							new_genome->mutate_gene_reenable();
 						}
@@ -627,7 +618,7 @@ bool Species::reproduce(int generation, Population *pop,std::vector<Species*> &s
 			else {
 
 				//Choose the random mom
-				orgnum=randint(0,poolsize);
+				orgnum=rng.randint(0,poolsize);
 				curorg=organisms.begin();
 				for(orgcount=0;orgcount<orgnum;orgcount++)
 					++curorg;
@@ -650,10 +641,10 @@ bool Species::reproduce(int generation, Population *pop,std::vector<Species*> &s
 
 				//Choose random dad
 
-				if ((randfloat()>NEAT::interspecies_mate_rate)) {
+				if ((rng.randfloat()>NEAT::interspecies_mate_rate)) {
 					//Mate within Species
 
-					orgnum=randint(0,poolsize);
+					orgnum=rng.randint(0,poolsize);
 					curorg=organisms.begin();
 					for(orgcount=0;orgcount<orgnum;orgcount++)
 						++curorg;
@@ -688,7 +679,7 @@ bool Species::reproduce(int generation, Population *pop,std::vector<Species*> &s
 						//randspeciesnum=randint(0,(pop->species).size()-1);
 
 						//Choose a random species tending towards better species
-						randmult=gaussrand()/4;
+						randmult=rng.gaussrand()/4;
 						if (randmult>1.0) randmult=1.0;
 						//This tends to select better species
 						randspeciesnum=(int) floor((randmult*(sorted_species.size()-1.0))+0.5);
@@ -718,63 +709,61 @@ bool Species::reproduce(int generation, Population *pop,std::vector<Species*> &s
 				}
 
 				//Perform mating based on probabilities of differrent mating types
-				if (randfloat()<NEAT::mate_multipoint_prob) { 
-					new_genome=(mom->gnome)->mate_multipoint(dad->gnome,count,mom->orig_fitness,dad->orig_fitness,outside);
+				if (rng.randfloat()<NEAT::mate_multipoint_prob) { 
+					new_genome=(mom->gnome)->mate_multipoint(dad->gnome,count,mom->orig_fitness,dad->orig_fitness,outside,rng);
 				}
-				else if (randfloat()<(NEAT::mate_multipoint_avg_prob/(NEAT::mate_multipoint_avg_prob+NEAT::mate_singlepoint_prob))) {
-					new_genome=(mom->gnome)->mate_multipoint_avg(dad->gnome,count,mom->orig_fitness,dad->orig_fitness,outside);
+				else if (rng.randfloat()<(NEAT::mate_multipoint_avg_prob/(NEAT::mate_multipoint_avg_prob+NEAT::mate_singlepoint_prob))) {
+					new_genome=(mom->gnome)->mate_multipoint_avg(dad->gnome,count,mom->orig_fitness,dad->orig_fitness,outside,rng);
 				}
 				else {
-					new_genome=(mom->gnome)->mate_singlepoint(dad->gnome,count);
+					new_genome=(mom->gnome)->mate_singlepoint(dad->gnome,count,rng);
 				}
 
 				mate_baby=true;
 
 				//Determine whether to mutate the baby's Genome
 				//This is done randomly or if the mom and dad are the same organism
-				if ((randfloat()>NEAT::mate_only_prob)||
+				if ((rng.randfloat()>NEAT::mate_only_prob)||
 					((dad->gnome)->genome_id==(mom->gnome)->genome_id)||
 					(((dad->gnome)->compatibility(mom->gnome))==0.0))
 				{
 
 					//Do the mutation depending on probabilities of 
 					//various mutations
-					if (randfloat()<NEAT::mutate_add_node_prob) {
-						new_genome->mutate_add_node(pop->innovations,pop->cur_node_id,pop->cur_innov_num);
+					if (rng.randfloat()<NEAT::mutate_add_node_prob) {
+						new_genome->mutate_add_node(innovs,cur_node_id,cur_innov_num,rng);
 						//  std::cout<<"mutate_add_node: "<<new_genome<<std::endl;
 						mut_struct_baby=true;
 					}
-					else if (randfloat()<NEAT::mutate_add_link_prob) {
-						net_analogue=new_genome->genesis(generation);
-						new_genome->mutate_add_link(pop->innovations,pop->cur_innov_num,NEAT::newlink_tries);
-						delete net_analogue;
+					else if (rng.randfloat()<NEAT::mutate_add_link_prob) {
+						new_genome->mutate_add_link(innovs,cur_innov_num,NEAT::newlink_tries,rng);
 						//std::cout<<"mutate_add_link: "<<new_genome<<std::endl;
 						mut_struct_baby=true;
 					}
 					else {
 						//Only do other mutations when not doing sturctural mutations
 
-						if (randfloat()<NEAT::mutate_random_trait_prob) {
-							new_genome->mutate_random_trait();
+						if (rng.randfloat()<NEAT::mutate_random_trait_prob) {
+							new_genome->mutate_random_trait(rng);
 							//std::cout<<"..mutate random trait: "<<new_genome<<std::endl;
 						}
-						if (randfloat()<NEAT::mutate_link_trait_prob) {
-							new_genome->mutate_link_trait(1);
+						if (rng.randfloat()<NEAT::mutate_link_trait_prob) {
+							new_genome->mutate_link_trait(1,rng);
 							//std::cout<<"..mutate link trait: "<<new_genome<<std::endl;
 						}
-						if (randfloat()<NEAT::mutate_node_trait_prob) {
-							new_genome->mutate_node_trait(1);
+						if (rng.randfloat()<NEAT::mutate_node_trait_prob) {
+							new_genome->mutate_node_trait(1,rng);
 							//std::cout<<"mutate_node_trait: "<<new_genome<<std::endl;
 						}
-						if (randfloat()<NEAT::mutate_link_weights_prob) {
-							new_genome->mutate_link_weights(mut_power,1.0,GAUSSIAN);
+						if (rng.randfloat()<NEAT::mutate_link_weights_prob) {
+							new_genome->mutate_link_weights(mut_power,1.0,GAUSSIAN,rng);
 							//std::cout<<"mutate_link_weights: "<<new_genome<<std::endl;
 						}
-						if (randfloat()<NEAT::mutate_toggle_enable_prob) {
-							new_genome->mutate_toggle_enable(1);
+						if (rng.randfloat()<NEAT::mutate_toggle_enable_prob) {
+							new_genome->mutate_toggle_enable(1,rng);
 							//std::cout<<"mutate_toggle_enable: "<<new_genome<<std::endl;
 						}
-						if (randfloat()<NEAT::mutate_gene_reenable_prob) {
+						if (rng.randfloat()<NEAT::mutate_gene_reenable_prob) {
 							new_genome->mutate_gene_reenable(); 
 							//std::cout<<"mutate_gene_reenable: "<<new_genome<<std::endl;
 						}
@@ -791,56 +780,12 @@ bool Species::reproduce(int generation, Population *pop,std::vector<Species*> &s
 
 			}
 
-			//Add the baby to its proper Species
-			//If it doesn't fit a Species, create a new one
-
 			baby->mut_struct_baby=mut_struct_baby;
 			baby->mate_baby=mate_baby;
 
-			curspecies=(pop->species).begin();
-			if (curspecies==(pop->species).end()){
-				//Create the first species
-				newspecies=new Species(++(pop->last_species),true);
-				(pop->species).push_back(newspecies);
-				newspecies->add_Organism(baby);  //Add the baby
-				baby->species=newspecies;  //Point the baby to its species
-			} 
-			else {
-				comporg=(*curspecies)->first();
-				found=false;
-				while((curspecies!=(pop->species).end())&&
-					(!found)) {	
-						if (comporg==0) {
-							//Keep searching for a matching species
-							++curspecies;
-							if (curspecies!=(pop->species).end())
-								comporg=(*curspecies)->first();
-						}
-						else if (((baby->gnome)->compatibility(comporg->gnome))<NEAT::compat_threshold) {
-							//Found compatible species, so add this organism to it
-							(*curspecies)->add_Organism(baby);
-							baby->species=(*curspecies);  //Point organism to its species
-							found=true;  //Note the search is over
-						}
-						else {
-							//Keep searching for a matching species
-							++curspecies;
-							if (curspecies!=(pop->species).end()) 
-								comporg=(*curspecies)->first();
-						}
-					}
-
-					//If we didn't find a match, create a new species
-					if (found==false) {
-					  newspecies=new Species(++(pop->last_species),true);
-					  //std::std::cout<<"CREATING NEW SPECIES "<<pop->last_species<<std::std::endl;
-					  (pop->species).push_back(newspecies);
-					  newspecies->add_Organism(baby);  //Add the baby
-					  baby->species=newspecies;  //Point baby to its species
-					}
-
-
-			} //end else 
+			//The Population adds the babies to their proper Species
+			//once every Species has reproduced
+			babies.push_back(baby);
 
 		}
 
@@ -84,7 +84,10 @@ namespace NEAT {
 		Organism *get_champ();
 
 		//Perform mating and mutation to form next generation
-		bool reproduce(int generation, Population *pop,std::vector<Species*> &sorted_species);
+		//The offspring are appended to babies, without a Species yet
+		//Structural mutations are matched against innovs and numbered from
+		//cur_node_id and cur_innov_num, which may be shared or local to the Species
+		bool reproduce(int generation,InnovationDatabase &innovs,int &cur_node_id,double &cur_innov_num,std::vector<Species*> &sorted_species,RNG &rng,std::vector<Organism*> &babies);
 
 		// *** Real-time methods *** 
 
@@ -0,0 +1,148 @@
+#include "thread_pool.h"
+
+#include <algorithm>
+
+namespace NEAT
+{
+  ThreadPool::ThreadPool(std::size_t threadCount) :
+    m_queuedTasks(0),
+    m_stop(false)
+  {
+    if(threadCount == 0) {
+      threadCount = std::max<std::size_t>(std::thread::hardware_concurrency(), 1);
+    }
+
+    for(std::size_t i = 1; i < threadCount; ++i) {
+      m_workers.push_back(std::make_unique<Worker>());
+    }
+    for(std::size_t i = 0; i < m_workers.size(); ++i) {
+      m_threads.emplace_back(&ThreadPool::workerLoop, this, i);
+    }
+  }
+
+  ThreadPool::~ThreadPool()
+  {
+    {
+      std::lock_guard<std::mutex> lock(m_wakeMutex);
+      m_stop = true;
+    }
+    m_wake.notify_all();
+
+    for(auto& thread : m_threads) {
+      thread.join();
+    }
+  }
+
+  void ThreadPool::parallelFor(std::size_t count, const std::function<void(std::size_t)>& task)
+  {
+    if(count == 0) {
+      return;
+    }
+
+    // no workers, or nothing to share
+    if(m_workers.empty() || count == 1) {
+      for(std::size_t i = 0; i < count; ++i) {
+        task(i);
+      }
+      return;
+    }
+
+    auto job = std::make_shared<Job>();
+    job->remaining = count;
+
+    // deal the tasks round robin, the stealing evens out the rest
+    {
+      std::lock_guard<std::mutex> lock(m_wakeMutex);
+      m_queuedTasks += count;
+    }
+    for(std::size_t i = 0; i < count; ++i) {
+      auto& worker = *m_workers[i % m_workers.size()];
+      std::lock_guard<std::mutex> lock(worker.mutex);
+      worker.tasks.push_back(Task{ job, &task, i });
+    }
+    m_wake.notify_all();
+
+    // help out until the queues are empty, then wait for the running tasks
+    Task stolen;
+    while(job->remaining > 0 && stealTask(m_workers.size(), stolen)) {
+      runTask(stolen);
+    }
+
+    {
+      std::unique_lock<std::mutex> lock(job->mutex);
+      job->done.wait(lock, [&job] { return job->remaining == 0; });
+    }
+
+    if(job->exception) {
+      std::rethrow_exception(job->exception);
+    }
+  }
+
+  void ThreadPool::workerLoop(std::size_t index)
+  {
+    Task task;
+    while(true) {
+      if(popTask(index, task) || stealTask(index, task)) {
+        runTask(task);
+        continue;
+      }
+
+      std::unique_lock<std::mutex> lock(m_wakeMutex);
+      m_wake.wait(lock, [this] { return m_stop || m_queuedTasks > 0; });
+      if(m_stop) {
+        return;
+      }
+    }
+  }
+
+  bool ThreadPool::popTask(std::size_t worker, Task& task)
+  {
+    auto& own = *m_workers[worker];
+    std::lock_guard<std::mutex> lock(own.mutex);
+    if(own.tasks.empty()) {
+      return false;
+    }
+
+    task = std::move(own.tasks.back());
+    own.tasks.pop_back();
+    --m_queuedTasks;
+
+    return true;
+  }
+
+  bool ThreadPool::stealTask(std::size_t thief, Task& task)
+  {
+    // the calling thread of parallelFor steals with index m_workers.size()
+    for(std::size_t i = 1; i <= m_workers.size(); ++i) {
+      auto& victim = *m_workers[(thief + i) % m_workers.size()];
+      std::lock_guard<std::mutex> lock(victim.mutex);
+      if(!victim.tasks.empty()) {
+        task = std::move(victim.tasks.front());
+        victim.tasks.pop_front();
+        --m_queuedTasks;
+
+        return true;
+      }
+    }
+
+    return false;
+  }
+
+  void ThreadPool::runTask(Task& task)
+  {
+    try {
+      (*task.function)(task.index);
+    } catch(...) {
+      std::lock_guard<std::mutex> lock(task.job->mutex);
+      if(!task.job->exception) {
+        task.job->exception = std::current_exception();
+      }
+    }
+
+    auto job = std::move(task.job);
+    if(--job->remaining == 0) {
+      std::lock_guard<std::mutex> lock(job->mutex);
+      job->done.notify_all();
+    }
+  }
+}
@@ -0,0 +1,74 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace NEAT
+{
+  // Work stealing thread pool. Every worker owns a task deque, pops its own
+  // tasks from the back and steals from the front of the other workers
+  // when it runs dry. The thread calling parallelFor helps with the work,
+  // so a pool of n threads only spawns n - 1 workers
+  class ThreadPool
+  {
+  public:
+    // 0 uses every hardware thread
+    explicit ThreadPool(std::size_t threadCount = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Calls task(i) for every i in [0, count) and returns once all of them
+    // are done. The first exception thrown by a task is rethrown here
+    void parallelFor(std::size_t count, const std::function<void(std::size_t)>& task);
+
+    std::size_t getThreadCount() const { return m_workers.size() + 1; }
+
+  private:
+    struct Job
+    {
+      std::atomic<std::size_t>  remaining;
+      std::mutex                mutex;
+      std::condition_variable   done;
+      std::exception_ptr        exception;
+    };
+
+    struct Task
+    {
+      std::shared_ptr<Job>                          job;
+      const std::function<void(std::size_t)>*       function;
+      std::size_t                                   index;
+    };
+
+    struct Worker
+    {
+      std::mutex        mutex;
+      std::deque<Task>  tasks;
+    };
+
+    void workerLoop(std::size_t index);
+
+    bool popTask(std::size_t worker, Task& task);
+    bool stealTask(std::size_t thief, Task& task);
+    void runTask(Task& task);
+
+    std::vector<std::unique_ptr<Worker>>  m_workers;
+    std::vector<std::thread>              m_threads;
+
+    std::mutex                            m_wakeMutex;
+    std::condition_variable               m_wake;
+    std::atomic<std::size_t>              m_queuedTasks;
+    bool                                  m_stop;
+  };
+}
+
+#endif // THREAD_POOL_H
@@ -18,6 +18,7 @@
 
 #include <fstream>
 #include "neat.h"
+#include "pool.h"
 
 namespace NEAT {
 
@@ -27,7 +28,7 @@ namespace NEAT {
 	//        algorithm from having to search vast parameter landscapes  
 	//        on every node.  Instead, each node can simply point to a trait 
 	//        and those traits can evolve on their own 
-	class Trait {
+	class Trait : public PoolAllocated<Trait> {
 
 		// ************ LEARNING PARAMETERS *********** 
 		// The following parameters are for use in    
@@ -59,7 +60,7 @@ namespace NEAT {
 	void print_to_file(std::ofstream &outFile);
 
 		// Perturb the trait parameters slightly
-		void mutate();
+		void mutate(RNG &rng);
 
 	};
 
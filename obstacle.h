@@ -17,19 +17,22 @@
 #ifndef OBSTACLE_H
 #define OBSTACLE_H
 
-#include <SFML/Graphics.hpp>
+#include "geometry.h"
 
 namespace flappybirdplusplus
 {
     struct Obstacle
     {
-        Obstacle(float x, float y, float width, float height) : position(x, y), oldPosition(x, y), dimension(width, height) {}
+        Obstacle() : Obstacle(0, 0, 0, 0) {}
+        Obstacle(Fixed x, Fixed y, Fixed width, Fixed height) : position(x, y), oldPosition(x, y), dimension(width, height) {}
 
         void preReset();
 
-        sf::Vector2f position;
-        sf::Vector2f oldPosition;
-        sf::Vector2f dimension;
+        AABB getOOBB() const { return AABB(position.x, position.y, dimension.x, dimension.y); }
+
+        FixedVector2 position;
+        FixedVector2 oldPosition;
+        FixedVector2 dimension;
     };
 }
 
@@ -0,0 +1,267 @@
+/**
+ * FlappyBird++
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ **/
+#include <cassert>
+#include "neat/profiler.h"
+#include "simulation.h"
+
+namespace flappybirdplusplus
+{
+    Simulation::Simulation(unsigned int width, unsigned int height) :
+        m_birds(1),
+        m_aliveBirds(1, 0),
+        m_firstObstacle(0),
+        m_foregroundOOBB(0, toFixed(static_cast<int>(height - FOREGROUND_Y)), toFixed(static_cast<int>(width)),
+                         toFixed(static_cast<int>(FOREGROUND_Y))),
+        m_currentObstacleIndex(0),
+        m_nextObstacleIndex(0),
+        m_nextCoursePair(0),
+        m_width(width),
+        m_height(height),
+        m_score(0),
+        m_started(false),
+        m_dead(false),
+        m_invincible(false)
+    {
+    }
+
+    void Simulation::reset(std::size_t birdCount, std::shared_ptr<const Course> course)
+    {
+        assert(course->getHeight() == m_height);
+        m_course = std::move(course);
+
+        m_swarm.reset(birdCount, toFixed(static_cast<int>(BIRD_STARTING_X)), toFixed(static_cast<int>(m_height / 2)));
+        m_birds.assign(birdCount, BirdState());
+        m_aliveBirds = m_swarm.getIds();
+
+        m_score = 0;
+        m_currentObstacleIndex = 0;
+        m_nextObstacleIndex = 0;
+        m_started = false;
+        m_dead = false;
+
+        // the first pairs of the course, the rest come on as these scroll off
+        Fixed startingX = 0;
+        m_firstObstacle = 0;
+        m_nextCoursePair = 0;
+        for(auto& obstacle : m_obstacles) {
+            const auto& pair = m_course->getPair(m_nextCoursePair++);
+            startingX += toFixed(pair.distance);
+            obstacle = createObstaclePair(startingX, pair);
+        }
+    }
+
+    void Simulation::reset(std::size_t birdCount, std::uint32_t courseSeed)
+    {
+        reset(birdCount, std::make_shared<const Course>(courseSeed, m_height));
+    }
+
+    void Simulation::start()
+    {
+        m_started = true;
+    }
+
+    void Simulation::flap(std::size_t bird)
+    {
+        m_swarm.applyUpForce(bird);
+    }
+
+    void Simulation::releaseFlap(std::size_t bird)
+    {
+        m_swarm.resetUpForce(bird);
+    }
+
+    bool Simulation::control(bool flapping, std::size_t bird)
+    {
+        // keeps flapping as long as the controller holds the button, and only
+        // resets the forces once the button is released
+        auto& state = m_birds[bird];
+        if(flapping) {
+            m_swarm.applyUpForce(bird);
+            state.flapping = true;
+        } else if(state.flapping) {
+            state.flapping = false;
+            m_swarm.resetUpForce(bird);
+        }
+
+        return flapping;
+    }
+
+    unsigned int Simulation::step()
+    {
+        NEAT_PROFILE_HOT_SCOPE("simulation_step");
+
+        unsigned int events = STEP_EVENT_NONE;
+
+        // let the dead birds fall to the ground
+        m_swarm.updateFalling(m_foregroundOOBB);
+
+        if(m_dead || !m_started)
+            return events;
+
+        // the birds that hit something are only marked, they all leave the
+        // swarm together at the end of the step
+        m_swarm.updateAlive();
+        if(!m_invincible)
+            m_swarm.markHits(m_foregroundOOBB);
+
+        // the obstacles are shared by every bird, so they are only moved once per step.
+        // Only the closest pair can scroll off the screen, its slot then takes the new
+        // pair behind the farthest one, which is moved at the end of this loop
+        for(std::size_t i = 0; i < OBSTACLE_COUNT;) {
+            auto& [upperObstacle, lowerObstacle] = obstacleAt(i);
+
+            upperObstacle.oldPosition = upperObstacle.position;
+            upperObstacle.position.x -= SCROLL_SPEED;
+            lowerObstacle.oldPosition = lowerObstacle.position;
+            lowerObstacle.position.x -= SCROLL_SPEED;
+
+            if(upperObstacle.position.x <= toFixed(-OBSTACLE_WIDTH)) {
+                const auto& lastObstacle = getObstacle(OBSTACLE_COUNT - 1);
+                const auto& pair = m_course->getPair(m_nextCoursePair++);
+                m_obstacles[m_firstObstacle] = createObstaclePair(lastObstacle.first.position.x + toFixed(pair.distance), pair);
+                m_firstObstacle = (m_firstObstacle + 1) % OBSTACLE_COUNT;
+
+                --m_currentObstacleIndex;
+                --m_nextObstacleIndex;
+            } else {
+                ++i;
+            }
+        }
+
+        // the birds all fly at the same x, so they sense the same pair and
+        // only that pair can hit them
+        auto birdX = m_swarm.getFixedPosition(0).x;
+        while(m_nextObstacleIndex + 1 < OBSTACLE_COUNT && !isAhead(getObstacle(m_nextObstacleIndex).first, birdX))
+            ++m_nextObstacleIndex;
+        if(!m_invincible) {
+            const auto& [upperObstacle, lowerObstacle] = getObstacle(m_nextObstacleIndex);
+            m_swarm.markHits(upperObstacle.getOOBB());
+            m_swarm.markHits(lowerObstacle.getOOBB());
+        }
+
+        // drop the birds that died during this step from the alive list
+        if(!m_invincible) {
+            for(auto bird : m_swarm.removeHits()) {
+                kill(bird);
+                events |= STEP_EVENT_DIED;
+            }
+            if(events & STEP_EVENT_DIED)
+                m_aliveBirds.assign(m_swarm.getIds().begin(), m_swarm.getIds().begin() + m_swarm.getAliveCount());
+        }
+
+        if(!m_aliveBirds.empty()) {
+            const auto& currentObstacle = getObstacle(m_currentObstacleIndex);
+            if(currentObstacle.first.position.x <= toFixed(static_cast<int>(BIRD_STARTING_X) - 17 - OBSTACLE_WIDTH)) {
+                ++m_currentObstacleIndex;
+                ++m_score;
+                events |= STEP_EVENT_SCORED;
+            }
+        } else {
+            finish();
+        }
+
+        return events;
+    }
+
+    void Simulation::finish()
+    {
+        m_dead = true;
+        m_started = false;
+        for(auto& [ob1, ob2] : m_obstacles) {
+            ob1.preReset();
+            ob2.preReset();
+        }
+    }
+
+    std::array<double, Simulation::SENSOR_COUNT> Simulation::getSensorInputs(std::size_t bird) const
+    {
+        auto birdPosition = m_swarm.getFixedPosition(bird);
+
+        // the nearest obstacle pair that the bird has not yet passed
+        const auto& [upperObstacle, lowerObstacle] = getNextObstacle();
+        const auto& upperObstaclePosition = upperObstacle.position;
+        const auto& upperObstacleDimension = upperObstacle.dimension;
+        const auto& lowerObstaclePosition = lowerObstacle.position;
+
+        std::array<double, SENSOR_COUNT> input;
+        input[0] = 1.0;
+        input[1] = toDouble(lowerObstaclePosition.x - birdPosition.x) / 1000.0;
+        input[2] = toDouble((upperObstaclePosition.y + upperObstacleDimension.y) - birdPosition.y) / 1000.0;
+        input[3] = toDouble(lowerObstaclePosition.y - birdPosition.y) / 1000.0;
+
+        return input;
+    }
+
+    void Simulation::kill(std::size_t bird)
+    {
+        // the swarm has already stopped its flap
+        auto& state = m_birds[bird];
+        state.dead = true;
+        state.flapping = false;
+        state.score = m_score;
+    }
+
+    std::pair<Obstacle, Obstacle> Simulation::createObstaclePair(Fixed startingPositionX, const Course::Pair& pair) const
+    {
+        auto height = static_cast<int>(m_height);
+        auto foregroundY = static_cast<int>(FOREGROUND_Y);
+
+        auto upperObstacleHeight = static_cast<int>(pair.upperHeight);
+        auto lowerObstacleHeight = height - upperObstacleHeight - 120 - foregroundY;
+
+        Obstacle upperObstacle(startingPositionX, 0, toFixed(52), toFixed(upperObstacleHeight));
+        Obstacle lowerObstacle(startingPositionX, toFixed(height - lowerObstacleHeight - foregroundY), toFixed(52),
+                               toFixed(lowerObstacleHeight));
+
+        return { upperObstacle, lowerObstacle };
+    }
+
+    bool Simulation::isAhead(const Obstacle& obstacle, Fixed birdX)
+    {
+        return birdX < obstacle.position.x + obstacle.dimension.x + toFixed(SENSOR_MARGIN);
+    }
+
+    std::uint64_t Simulation::getChecksum() const
+    {
+        // FNV-1a over the fixed point state, the same on every platform
+        std::uint64_t hash = 14695981039346656037ull;
+        auto add = [&hash](std::int64_t value) {
+            for(auto i = 0; i < 8; ++i) {
+                hash ^= static_cast<std::uint64_t>(value >> (i * 8)) & 0xff;
+                hash *= 1099511628211ull;
+            }
+        };
+
+        for(std::size_t i = 0; i < m_birds.size(); ++i) {
+            add(m_swarm.getFixedPosition(i).x);
+            add(m_swarm.getFixedPosition(i).y);
+            add(m_swarm.getFixedRotation(i));
+            add(m_birds[i].score);
+            add(m_birds[i].dead);
+        }
+        for(std::size_t i = 0; i < OBSTACLE_COUNT; ++i) {
+            const auto& [upperObstacle, lowerObstacle] = getObstacle(i);
+            add(upperObstacle.position.x);
+            add(upperObstacle.dimension.y);
+            add(lowerObstacle.position.y);
+        }
+        add(m_score);
+        add(m_dead);
+
+        return hash;
+    }
+}
@@ -0,0 +1,156 @@
+/**
+ * FlappyBird++
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ **/
+#ifndef SIMULATION_H
+#define SIMULATION_H
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "birdswarm.h"
+#include "course.h"
+#include "geometry.h"
+#include "obstacle.h"
+
+namespace flappybirdplusplus
+{
+    // The game rules (bird physics, obstacles, collision and scoring) without
+    // any rendering or audio, so it can be stepped as fast as the cpu allows.
+    // Any number of birds fly in lockstep through the same obstacle course,
+    // which is read from a Course that several simulations can share
+    class Simulation
+    {
+    public:
+        static constexpr float          TIME_STEP = 1.0f / TICKS_PER_SECOND;
+        static constexpr float          FOREGROUND_Y = 100.f;
+        static constexpr float          BIRD_STARTING_X = 50.f;
+
+        // the obstacles scroll 100 pixels per second
+        static constexpr Fixed          SCROLL_SPEED = perTick(100);
+        static constexpr std::size_t    SENSOR_COUNT = 4;
+
+        // obstacle pairs on the screen and ahead of it at any time
+        static constexpr std::size_t    OBSTACLE_COUNT = 10;
+        static constexpr int            OBSTACLE_WIDTH = 52;
+
+        // the birds sense a pair until they are 25 pixels past it, and that
+        // pair is the only one that can touch them: the one before is behind
+        // the birds and the one after has not reached them yet
+        static constexpr int            SENSOR_MARGIN = 25;
+        static_assert(BirdSwarm::WIDTH / 2 < toFixed(SENSOR_MARGIN) &&
+                      BirdSwarm::WIDTH / 2 <= toFixed(Course::MIN_DISTANCE - OBSTACLE_WIDTH - SENSOR_MARGIN),
+                      "only the sensed obstacle pair may collide with the birds");
+
+        enum StepEvent : unsigned int
+        {
+            STEP_EVENT_NONE = 0,
+            STEP_EVENT_SCORED = 1 << 0,
+            STEP_EVENT_DIED = 1 << 1
+        };
+
+        Simulation(unsigned int width, unsigned int height);
+
+        // the course must have been built for the height of the simulation
+        void reset(std::size_t birdCount, std::shared_ptr<const Course> course);
+        void reset(std::size_t birdCount, std::uint32_t courseSeed);
+        void start();
+
+        void flap(std::size_t bird = 0);
+        void releaseFlap(std::size_t bird = 0);
+        bool control(bool flapping, std::size_t bird = 0);
+
+        // advances the game by one tick of TIME_STEP seconds
+        unsigned int step();
+
+        // ends the game as if every bird had died, the birds still flying
+        // keep the score of the game
+        void finish();
+
+        std::array<double, SENSOR_COUNT> getSensorInputs(std::size_t bird = 0) const;
+
+        void setInvincible(bool invincible) { m_invincible = invincible; }
+
+        std::size_t getBirdCount() const { return m_birds.size(); }
+        std::size_t getAliveCount() const { return m_aliveBirds.size(); }
+        const std::vector<std::size_t>& getAliveBirds() const { return m_aliveBirds; }
+        const BirdSwarm& getBirds() const { return m_swarm; }
+        unsigned int getScore(std::size_t bird) const { return m_birds[bird].dead ? m_birds[bird].score : m_score; }
+        bool isDead(std::size_t bird) const { return m_birds[bird].dead; }
+
+        // the obstacle pairs from the closest to the farthest, and the pair
+        // the birds are flying through or towards
+        const std::pair<Obstacle, Obstacle>& getObstacle(std::size_t i) const { return m_obstacles[(m_firstObstacle + i) % OBSTACLE_COUNT]; }
+        const std::pair<Obstacle, Obstacle>& getNextObstacle() const { return getObstacle(m_nextObstacleIndex); }
+        const Course& getCourse() const { return *m_course; }
+        const AABB& getForegroundOOBB() const { return m_foregroundOOBB; }
+        unsigned int getWidth() const { return m_width; }
+        unsigned int getHeight() const { return m_height; }
+        unsigned int getScore() const { return m_score; }
+        bool isStarted() const { return m_started; }
+        bool isDead() const { return m_dead; }
+
+        // hash of every bird and obstacle, equal checksums after equal
+        // steps mean equal games
+        std::uint64_t getChecksum() const;
+
+    private:
+        struct BirdState
+        {
+            unsigned int    score = 0;
+            bool            dead = false;
+            bool            flapping = false;
+        };
+
+        void kill(std::size_t bird);
+
+        std::pair<Obstacle, Obstacle> createObstaclePair(Fixed startingPositionX, const Course::Pair& pair) const;
+
+        // the bird has not yet flown SENSOR_MARGIN past the obstacle
+        static bool isAhead(const Obstacle& obstacle, Fixed birdX);
+
+        BirdSwarm                                   m_swarm;
+        std::vector<BirdState>                      m_birds;
+        std::vector<std::size_t>                    m_aliveBirds;
+
+        std::pair<Obstacle, Obstacle>& obstacleAt(std::size_t i) { return m_obstacles[(m_firstObstacle + i) % OBSTACLE_COUNT]; }
+
+        // a ring, the pair that scrolls off the screen is replaced by a new
+        // one behind the farthest pair
+        std::array<std::pair<Obstacle, Obstacle>, OBSTACLE_COUNT> m_obstacles;
+        std::size_t                                 m_firstObstacle;
+        AABB                                        m_foregroundOOBB;
+
+        // counted from the closest pair, the next pair to score and the
+        // pair that is sensed and checked for collisions
+        std::size_t                                 m_currentObstacleIndex;
+        std::size_t                                 m_nextObstacleIndex;
+
+        // the course pair that comes on the screen next
+        std::shared_ptr<const Course>               m_course;
+        std::size_t                                 m_nextCoursePair;
+
+        unsigned int                                m_width;
+        unsigned int                                m_height;
+        unsigned int                                m_score;
+
+        bool                                        m_started;
+        bool                                        m_dead;
+        bool                                        m_invincible;
+    };
+}
+
+#endif // SIMULATION_H
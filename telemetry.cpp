@@ -0,0 +1,196 @@
+/**
+ * FlappyBird++
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ **/
+#include <cmath>
+#include <cstdio>
+#include "telemetry.h"
+
+namespace flappybirdplusplus
+{
+namespace
+{
+    // how long buffered events may wait before they are written
+    constexpr auto DRAIN_INTERVAL = std::chrono::milliseconds(100);
+}
+    Telemetry::Telemetry() :
+        m_level(LEVEL_OFF),
+        m_stepInterval(1),
+        m_head(0),
+        m_count(0),
+        m_dropped(0),
+        m_stop(false)
+    {
+    }
+
+    Telemetry::~Telemetry()
+    {
+        close();
+    }
+
+    bool Telemetry::open(const std::string& filename, Level level, std::uint64_t stepInterval)
+    {
+        close();
+
+        m_out.open(filename);
+        if(!m_out.is_open())
+            return false;
+
+        m_stepInterval = stepInterval > 0 ? stepInterval : 1;
+        m_start = std::chrono::steady_clock::now();
+        m_ring.resize(CAPACITY);
+        m_head = 0;
+        m_count = 0;
+        m_dropped = 0;
+        m_stop = false;
+        m_thread = std::thread(&Telemetry::writerLoop, this);
+
+        m_level.store(level, std::memory_order_relaxed);
+        return true;
+    }
+
+    void Telemetry::close()
+    {
+        m_level.store(LEVEL_OFF, std::memory_order_relaxed);
+        if(!m_thread.joinable())
+            return;
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+        m_wake.notify_one();
+
+        // the loop writes what is still buffered before it quits
+        m_thread.join();
+        m_out.close();
+    }
+
+    void Telemetry::log(Level level, const char* event, std::uint64_t step, std::initializer_list<Field> fields)
+    {
+        if(!isEnabled(level))
+            return;
+
+        auto time = std::chrono::steady_clock::now();
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+        if(m_count == m_ring.size()) {
+            ++m_dropped;
+            return;
+        }
+
+        auto& record = m_ring[(m_head + m_count) % m_ring.size()];
+        record.time = time;
+        record.level = level;
+        record.event = event;
+        record.step = step;
+        record.fieldCount = 0;
+        for(const auto& field : fields) {
+            if(record.fieldCount == MAX_FIELDS)
+                break;
+            record.fields[record.fieldCount++] = field;
+        }
+
+        // wake the writer early instead of dropping events
+        if(++m_count == m_ring.size() / 2) {
+            lock.unlock();
+            m_wake.notify_one();
+        }
+    }
+
+    bool Telemetry::levelFromName(const std::string& name, Level& level)
+    {
+        for(auto l = static_cast<int>(LEVEL_TRACE); l <= LEVEL_OFF; ++l) {
+            if(name == levelName(static_cast<Level>(l))) {
+                level = static_cast<Level>(l);
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    const char* Telemetry::levelName(Level level)
+    {
+        switch(level) {
+        case LEVEL_TRACE: return "trace";
+        case LEVEL_DEBUG: return "debug";
+        case LEVEL_INFO: return "info";
+        case LEVEL_WARNING: return "warning";
+        case LEVEL_ERROR: return "error";
+        default: return "off";
+        }
+    }
+
+    void Telemetry::writerLoop()
+    {
+        std::vector<Record> records;
+        records.reserve(CAPACITY);
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+        while(true) {
+            m_wake.wait_for(lock, DRAIN_INTERVAL, [this]() { return m_stop || m_count >= m_ring.size() / 2; });
+
+            records.clear();
+            for(; m_count > 0; --m_count) {
+                records.push_back(m_ring[m_head]);
+                m_head = (m_head + 1) % m_ring.size();
+            }
+            auto dropped = m_dropped;
+            m_dropped = 0;
+            auto stop = m_stop;
+
+            // the game keeps logging while the file is written
+            lock.unlock();
+            write(records, dropped);
+            lock.lock();
+
+            if(stop)
+                return;
+        }
+    }
+
+    void Telemetry::write(const std::vector<Record>& records, std::uint64_t dropped)
+    {
+        char number[32];
+        for(const auto& record : records) {
+            auto time = std::chrono::duration<double, std::milli>(record.time - m_start).count();
+            std::snprintf(number, sizeof(number), "%.3f", time);
+
+            m_out << "{\"time_ms\":" << number
+                  << ",\"level\":\"" << levelName(record.level)
+                  << "\",\"event\":\"" << record.event
+                  << "\",\"step\":" << record.step;
+            for(std::size_t i = 0; i < record.fieldCount; ++i) {
+                m_out << ",\"" << record.fields[i].name << "\":";
+
+                // JSON has no nan or inf
+                if(std::isfinite(record.fields[i].value)) {
+                    std::snprintf(number, sizeof(number), "%.17g", record.fields[i].value);
+                    m_out << number;
+                } else {
+                    m_out << "null";
+                }
+            }
+            m_out << "}\n";
+        }
+
+        if(dropped > 0)
+            m_out << "{\"level\":\"warning\",\"event\":\"telemetry_dropped\",\"count\":" << dropped << "}\n";
+
+        // one flush per drain instead of one per event
+        m_out.flush();
+    }
+}
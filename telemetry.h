@@ -0,0 +1,117 @@
+/**
+ * FlappyBird++
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ **/
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <fstream>
+#include <initializer_list>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace flappybirdplusplus
+{
+    // Leveled, structured event log that keeps file I/O off the game loop.
+    // log() copies the event into a fixed ring buffer, a background thread
+    // drains it and writes one JSON object per line. When the ring is full
+    // the event is dropped and counted instead of blocking the caller.
+    // A closed sink has the level LEVEL_OFF, so the isEnabled() and
+    // shouldTraceStep() checks in front of the log calls are all it costs
+    class Telemetry
+    {
+    public:
+        enum Level : int
+        {
+            LEVEL_TRACE = 0,
+            LEVEL_DEBUG,
+            LEVEL_INFO,
+            LEVEL_WARNING,
+            LEVEL_ERROR,
+            LEVEL_OFF
+        };
+
+        static constexpr std::size_t    CAPACITY = 4096;
+        static constexpr std::size_t    MAX_FIELDS = 6;
+
+        // names must be string literals, only the pointer is kept
+        struct Field
+        {
+            const char*     name;
+            double          value;
+        };
+
+        Telemetry();
+        ~Telemetry();
+
+        Telemetry(const Telemetry&) = delete;
+        Telemetry& operator=(const Telemetry&) = delete;
+
+        // events below level are ignored, per step traces are only kept
+        // every stepInterval steps
+        bool open(const std::string& filename, Level level, std::uint64_t stepInterval = 1);
+        void close();
+
+        bool isEnabled(Level level) const { return level >= m_level.load(std::memory_order_relaxed); }
+        bool shouldTraceStep(std::uint64_t step) const
+        {
+            return isEnabled(LEVEL_TRACE) && step % m_stepInterval == 0;
+        }
+
+        // event must be a string literal too. Only the first MAX_FIELDS fields are kept
+        void log(Level level, const char* event, std::uint64_t step, std::initializer_list<Field> fields);
+
+        static bool levelFromName(const std::string& name, Level& level);
+        static const char* levelName(Level level);
+
+    private:
+        struct Record
+        {
+            std::chrono::steady_clock::time_point   time;
+            Level                                   level;
+            const char*                             event;
+            std::uint64_t                           step;
+            std::array<Field, MAX_FIELDS>           fields;
+            std::size_t                             fieldCount;
+        };
+
+        void writerLoop();
+        void write(const std::vector<Record>& records, std::uint64_t dropped);
+
+        std::atomic<int>                        m_level;
+        std::uint64_t                           m_stepInterval;
+
+        std::ofstream                           m_out;
+        std::chrono::steady_clock::time_point   m_start;
+
+        std::mutex                              m_mutex;
+        std::condition_variable                 m_wake;
+        std::vector<Record>                     m_ring;
+        std::size_t                             m_head;
+        std::size_t                             m_count;
+        std::uint64_t                           m_dropped;
+        bool                                    m_stop;
+        std::thread                             m_thread;
+    };
+}
+
+#endif // TELEMETRY_H
@@ -0,0 +1,190 @@
+/**
+ * FlappyBird++
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ **/
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <numeric>
+#include "neat/checkpoint.h"
+#include "neat/neat_initialize.h"
+#include "neat/organism.h"
+#include "neat/profiler.h"
+#include "neat/species.h"
+#include "batchevaluator.h"
+#include "trainer.h"
+
+namespace flappybirdplusplus
+{
+    Trainer::Trainer(unsigned int courseWidth, unsigned int courseHeight, std::size_t threadCount,
+                     std::uint64_t seed) :
+        m_seed(seed),
+        m_courseStream(NEAT::RNG(seed).stream(1)),
+        m_threadPool(threadCount),
+        m_checkpointWriter("population.bin", CHECKPOINTS_KEPT),
+        m_courseWidth(courseWidth),
+        m_courseHeight(courseHeight)
+    {
+        m_episodeLimits.maxSteps = MAX_EPISODE_STEPS;
+
+        NEAT::initializeParameters();
+        m_checkpointInterval = static_cast<std::size_t>(std::max(NEAT::print_every, 0));
+
+        // the binary checkpoint resumes the run where it stopped, the text
+        // file only brings the genomes back
+        std::uint64_t generation = 0;
+        if(std::filesystem::exists(std::filesystem::path("population.bin")) &&
+           (m_population = NEAT::Checkpoint::load("population.bin", generation))) {
+            m_generation = static_cast<std::size_t>(generation);
+        } else if(std::filesystem::exists(std::filesystem::path("population.txt"))) {
+            m_population = std::make_unique<NEAT::Population>("population.txt", seed);
+        } else {
+            m_startGenome = std::make_unique<NEAT::Genome>(4, 1, 1, 2);
+            m_population = std::make_unique<NEAT::Population>(m_startGenome.get(), 100, seed);
+        }
+
+        // later speciation runs on the evaluation threads
+        m_population->thread_pool = &m_threadPool;
+    }
+
+    Trainer::~Trainer()
+    {
+        savePopulation();
+    }
+
+    void Trainer::savePopulation()
+    {
+        NEAT_PROFILE_SCOPE("save_population");
+
+        m_checkpointWriter.submit(NEAT::Checkpoint::serialize(*m_population, m_generation));
+        if(!m_checkpointWriter.flush())
+            std::cerr << "Cannot write checkpoint \"population.bin\"!" << std::endl;
+
+        std::ofstream out("population.txt");
+        if(out.is_open()) {
+            m_population->print_to_file_by_species(out);
+        } else {
+            std::cerr << "Cannot write \"population.txt\"!" << std::endl;
+        }
+    }
+
+    void Trainer::evaluate()
+    {
+        NEAT_PROFILE_SCOPE("evaluate");
+
+        // every batch flies through the same course, built once and only read
+        // by the threads
+        auto course = createCourse();
+
+        const auto& organisms = m_population->organisms;
+        auto batchCount = std::min(organisms.size(), m_threadPool.getThreadCount() * BATCHES_PER_THREAD);
+        std::vector<std::uint64_t> activations(batchCount, 0);
+        m_threadPool.parallelFor(batchCount, [&](std::size_t batch) {
+            auto begin = organisms.begin() + (organisms.size() * batch) / batchCount;
+            auto end = organisms.begin() + (organisms.size() * (batch + 1)) / batchCount;
+
+            Simulation simulation(m_courseWidth, m_courseHeight);
+            BatchEvaluator evaluator(simulation);
+            evaluator.reset(std::vector<NEAT::Organism*>(begin, end), course);
+            evaluator.setLimits(m_episodeLimits);
+            evaluator.setDecisionInterval(m_decisionInterval);
+            evaluator.evaluate();
+            activations[batch] = evaluator.getActivations();
+        });
+
+        m_activations = std::accumulate(activations.begin(), activations.end(), std::uint64_t(0));
+    }
+
+    void Trainer::nextGeneration()
+    {
+        for(auto& specie : m_population->species) {
+            specie->compute_average_fitness();
+            specie->compute_max_fitness();
+        }
+
+        m_population->epoch(++m_generation);
+
+        // only the serialization runs here, the writer thread does the disk work
+        if(m_checkpointInterval > 0 && m_generation % m_checkpointInterval == 0) {
+            // the write of the previous checkpoint is done or still going,
+            // a failure is reported at the next one
+            if(m_checkpointWriter.pollFailure())
+                std::cerr << "Cannot write checkpoint \"population.bin\"!" << std::endl;
+            m_checkpointWriter.submit(NEAT::Checkpoint::serialize(*m_population, m_generation));
+        }
+
+#ifdef NEAT_PROFILING
+        // the evaluation and the epoch of the generation that just ended
+        std::clog << "Profile " << NEAT::Profiler::format(NEAT::Profiler::collect(m_generation - 1)) << std::endl;
+#endif
+    }
+
+    void Trainer::runGeneration()
+    {
+        evaluate();
+        nextGeneration();
+    }
+
+    void Trainer::run(std::size_t generations)
+    {
+        for(std::size_t i = 0; i < generations; ++i) {
+            auto start = std::chrono::steady_clock::now();
+
+            evaluate();
+
+            auto bestFitness = 0.0;
+            for(const auto* organism : m_population->organisms) {
+                bestFitness = std::max(bestFitness, organism->fitness);
+            }
+
+            auto evaluatedGeneration = m_generation;
+            nextGeneration();
+
+            auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start);
+            std::cout << "Generation " << evaluatedGeneration
+                      << " best fitness " << bestFitness
+                      << " species " << m_population->species.size()
+                      << " activations " << m_activations
+                      << " (" << elapsed.count() << " ms)" << std::endl;
+        }
+    }
+
+    std::shared_ptr<const Course> Trainer::createCourse() const
+    {
+        // one draw per generation, a few nanoseconds each
+        auto random = m_courseStream;
+        for(std::size_t generation = 1; generation < m_generation; ++generation) {
+            random.next();
+        }
+
+        auto seed = static_cast<std::uint32_t>(random.next() >> 32);
+        return std::make_shared<const Course>(seed, m_courseHeight);
+    }
+
+    double Trainer::activate(NEAT::CompiledNetwork& network, const std::array<double, Simulation::SENSOR_COUNT>& input)
+    {
+        network.loadSensors(input.data());
+        network.activate();
+
+        return network.getOutput(0);
+    }
+
+    double Trainer::computeFitness(const Simulation& simulation, std::size_t bird)
+    {
+        return simulation.getScore(bird) * 10;
+    }
+}
@@ -0,0 +1,116 @@
+/**
+ * FlappyBird++
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ **/
+#ifndef TRAINER_H
+#define TRAINER_H
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include "neat/checkpoint_writer.h"
+#include "neat/compiled_network.h"
+#include "neat/population.h"
+#include "neat/rng.h"
+#include "neat/thread_pool.h"
+#include "batchevaluator.h"
+#include "simulation.h"
+
+namespace flappybirdplusplus
+{
+    // Owns the NEAT population and evaluates its organisms on a Simulation.
+    // Used by the Game for the visual mode and by itself for headless training,
+    // where the population is split in batches that are evaluated in parallel
+    class Trainer
+    {
+    public:
+        static constexpr double         FLAP_THRESHOLD = 0.5;
+
+        // an organism that masters the course never dies, so by default
+        // every episode ends after 10 minutes of game time
+        static constexpr std::size_t    MAX_EPISODE_STEPS = 128 * 60 * 10;
+
+        // more batches than threads, so the threads that finish early
+        // can steal the batches of the long living birds
+        static constexpr std::size_t    BATCHES_PER_THREAD = 4;
+
+        // population.bin and the two checkpoints before it
+        static constexpr std::size_t    CHECKPOINTS_KEPT = 3;
+
+        // a thread count of 0 uses every hardware thread. The seed decides
+        // every course and every random decision of NEAT, so a run can be
+        // repeated bit for bit by passing the same seed again
+        Trainer(unsigned int courseWidth, unsigned int courseHeight, std::size_t threadCount = 1,
+                std::uint64_t seed = NEAT::RNG::makeSeed());
+        ~Trainer();
+
+        void savePopulation();
+
+        // a checkpoint is written in the background every that many
+        // generations, NEAT::print_every by default and 0 turns it off
+        void setCheckpointInterval(std::size_t generations) { m_checkpointInterval = generations; }
+
+        // bound every episode and with it the time of a generation, also
+        // used by the Game for its episodes
+        void setEpisodeLimits(const EpisodeLimits& limits) { m_episodeLimits = limits; }
+        const EpisodeLimits& getEpisodeLimits() const { return m_episodeLimits; }
+
+        // how often the birds ask their networks, every tick by default
+        void setDecisionInterval(const DecisionInterval& interval) { m_decisionInterval = interval; }
+        const DecisionInterval& getDecisionInterval() const { return m_decisionInterval; }
+
+        void evaluate();
+        void nextGeneration();
+        void runGeneration();
+        void run(std::size_t generations);
+
+        // the course of the current generation. Its seed is the generation's
+        // draw from the course stream of the seed, so a run resumed from a
+        // checkpoint flies the same courses as the run it continues
+        std::shared_ptr<const Course> createCourse() const;
+
+        static double activate(NEAT::CompiledNetwork& network, const std::array<double, Simulation::SENSOR_COUNT>& input);
+        static double computeFitness(const Simulation& simulation, std::size_t bird);
+
+        NEAT::Population& getPopulation() { return *m_population; }
+        std::size_t getGeneration() const { return m_generation; }
+        std::uint64_t getSeed() const { return m_seed; }
+
+        // network activations of the last evaluate()
+        std::uint64_t getActivations() const { return m_activations; }
+
+    private:
+        std::unique_ptr<NEAT::Genome>       m_startGenome;
+        std::unique_ptr<NEAT::Population>   m_population;
+        std::size_t                         m_generation = 1;
+
+        std::uint64_t                       m_seed;
+        NEAT::RNG                           m_courseStream;
+
+        NEAT::ThreadPool                    m_threadPool;
+
+        NEAT::CheckpointWriter              m_checkpointWriter;
+        std::size_t                         m_checkpointInterval;
+
+        EpisodeLimits                       m_episodeLimits;
+        DecisionInterval                    m_decisionInterval;
+        std::uint64_t                       m_activations = 0;
+
+        unsigned int                        m_courseWidth;
+        unsigned int                        m_courseHeight;
+    };
+}
+
+#endif // TRAINER_H